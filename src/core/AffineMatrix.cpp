@@ -0,0 +1,83 @@
+#include "AffineMatrix.h"
+
+AffineMatrix::AffineMatrix() {
+	rows[0] = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
+	rows[1] = glm::vec4(0.0f, 1.0f, 0.0f, 0.0f);
+	rows[2] = glm::vec4(0.0f, 0.0f, 1.0f, 0.0f);
+}
+
+AffineMatrix::AffineMatrix(const glm::mat4& matrix) {
+	for (i32 row = 0; row < 3; row++) {
+		rows[row] = glm::vec4(matrix[0][row], matrix[1][row], matrix[2][row], matrix[3][row]);
+	}
+}
+
+glm::mat4 AffineMatrix::ToMat4() const {
+	glm::mat4 matrix(1.0f);
+	for (i32 column = 0; column < 4; column++) {
+		matrix[column] = glm::vec4(Axis(column), column == 3 ? 1.0f : 0.0f);
+	}
+	return matrix;
+}
+
+glm::vec3 AffineMatrix::TransformPoint(const glm::vec3& point) const {
+	const glm::vec4 p(point, 1.0f);
+	return glm::vec3(glm::dot(rows[0], p), glm::dot(rows[1], p), glm::dot(rows[2], p));
+}
+
+glm::vec3 AffineMatrix::TransformVector(const glm::vec3& vector) const {
+	const glm::vec4 v(vector, 0.0f);
+	return glm::vec3(glm::dot(rows[0], v), glm::dot(rows[1], v), glm::dot(rows[2], v));
+}
+
+// Every row of the result is a combination of the other matrix's rows. The added w term is the
+// implicit (0, 0, 0, 1) row and only ever reaches the translation.
+AffineMatrix AffineMatrix::operator*(const AffineMatrix& other) const {
+	AffineMatrix result;
+	for (i32 row = 0; row < 3; row++) {
+		const glm::vec4& r = rows[row];
+		result.rows[row] = other.rows[0] * r.x + other.rows[1] * r.y + other.rows[2] * r.z + glm::vec4(0.0f, 0.0f, 0.0f, r.w);
+	}
+	return result;
+}
+
+// The transposed inverse has the cross products of the rows as its rows, so no transpose is needed
+glm::mat3 AffineMatrix::InverseTranspose() const {
+	const glm::vec3 a(rows[0]);
+	const glm::vec3 b(rows[1]);
+	const glm::vec3 c(rows[2]);
+
+	const glm::vec3 x = glm::cross(b, c);
+	const glm::vec3 y = glm::cross(c, a);
+	const glm::vec3 z = glm::cross(a, b);
+	const f32 inverseDet = 1.0f / glm::dot(a, x);
+
+	glm::mat3 result;
+	for (i32 column = 0; column < 3; column++) {
+		result[column] = glm::vec3(x[column], y[column], z[column]) * inverseDet;
+	}
+	return result;
+}
+
+AffineMatrix AffineMatrix::Inverse() const {
+	const glm::vec3 a(rows[0]);
+	const glm::vec3 b(rows[1]);
+	const glm::vec3 c(rows[2]);
+
+	// Columns of the inverse are the cross products of the rows over the determinant
+	const glm::vec3 x = glm::cross(b, c);
+	const glm::vec3 y = glm::cross(c, a);
+	const glm::vec3 z = glm::cross(a, b);
+	const f32 inverseDet = 1.0f / glm::dot(a, x);
+
+	AffineMatrix result;
+	for (i32 row = 0; row < 3; row++) {
+		result.rows[row] = glm::vec4(x[row], y[row], z[row], 0.0f) * inverseDet;
+	}
+
+	const glm::vec3 translation = -result.TransformVector(Translation());
+	for (i32 row = 0; row < 3; row++) {
+		result.rows[row].w = translation[row];
+	}
+	return result;
+}
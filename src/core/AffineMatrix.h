@@ -0,0 +1,33 @@
+#pragma once
+#include <glm/glm.hpp>
+#include "Base.h"
+
+// Transform matrix whose bottom row is always (0, 0, 0, 1), which holds for every scene node. Only the top three
+// rows are stored, 48 bytes instead of 64, laid out so they upload as is to a GLSL mat3x4 where
+// vec4(point, 1.0) * model transforms a point.
+struct AffineMatrix {
+	AffineMatrix();
+	explicit AffineMatrix(const glm::mat4& matrix);
+
+	glm::mat4 ToMat4() const;
+
+	// Column of the full matrix, 0-2 are the scaled local axes and 3 is the translation
+	glm::vec3 Axis(const i32 column) const { return glm::vec3(rows[0][column], rows[1][column], rows[2][column]); }
+	glm::vec3 Translation() const { return Axis(3); }
+
+	glm::vec3 TransformPoint(const glm::vec3& point) const;
+	glm::vec3 TransformVector(const glm::vec3& vector) const;
+
+	// Skips the multiplies against the implicit bottom row, 36 multiplies instead of 64
+	AffineMatrix operator*(const AffineMatrix& other) const;
+
+	// Inverts the 3x3 part through cofactors and applies it to the negated translation
+	AffineMatrix Inverse() const;
+
+	// Transforms normals so they stay perpendicular to surfaces under non uniform scale
+	glm::mat3 InverseTranspose() const;
+
+	const f32* Data() const { return &rows[0][0]; }
+
+	glm::vec4 rows[3];
+};
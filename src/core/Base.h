@@ -5,6 +5,7 @@
 using u8   = char;
 using i32  = int;
 using u32  = unsigned int;
+using u64  = unsigned long long;
 using f32  = float;
 using f64  = double;
 
@@ -4,6 +4,7 @@
 #include <glm/gtx/quaternion.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include "renderer/Mesh.h"
+#include "core/AffineMatrix.h"
 #include "core/Base.h"
 #include "ecs/Registry.h"
 
@@ -45,13 +46,23 @@ struct Transform {
 };
 
 struct LocalToWorld {
-    glm::mat4 matrix = glm::mat4(1.0f);
+    AffineMatrix matrix;
 
     Transform ToTransform() const;
     static LocalToWorld FromTransform(Transform& trans);
     static LocalToWorld From(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale);
 };
 
+// Inverse transpose of LocalToWorld's 3x3 part, kept up to date by the TransformSystem. It adds one to every
+// entity with a MeshRenderer, LocalToWorld and Transform.
+struct NormalMatrix {
+    glm::mat3 matrix = glm::mat3(1.0f);
+};
+
+// Marks an entity that never moves after it is created. Its matrices are computed once and its Transform must
+// not be written anymore, remove the tag to move it again. The parent of a static entity has to be static too.
+struct Static {};
+
 struct Parent {
     Entity entity;
 };
@@ -59,3 +70,11 @@ struct Parent {
 struct Children {
     std::vector<Entity> entities;
 };
+
+// Every component type, a type's position is its bit in entity masks. New components go at the end.
+using SceneComponents = ComponentList<Transform, LocalToWorld, NormalMatrix, MeshRenderer, Static, Parent, Children>;
+
+template<typename Component>
+struct ComponentIndex {
+    static constexpr u32 value = SceneComponents::IndexOf<Component>();
+};
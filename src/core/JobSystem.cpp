@@ -0,0 +1,81 @@
+#include "JobSystem.h"
+
+void JobSystem::Init(const u32 workerCount) {
+	s_Quit = false;
+	for (u32 i = 0; i < workerCount; i++) {
+		s_Workers.emplace_back(WorkerLoop, s_JobGeneration);
+	}
+}
+
+void JobSystem::Shutdown() {
+	{
+		std::lock_guard lock(s_Mutex);
+		s_Quit = true;
+	}
+	s_WakeUp.notify_all();
+
+	for (std::thread& worker : s_Workers) {
+		worker.join();
+	}
+	s_Workers.clear();
+}
+
+void JobSystem::ParallelFor(const u32 count, const std::function<void(u32)>& func) {
+	if (s_Workers.empty() || count <= 1) {
+		for (u32 i = 0; i < count; i++) {
+			func(i);
+		}
+		return;
+	}
+
+	{
+		std::lock_guard lock(s_Mutex);
+		s_Job = &func;
+		s_JobCount = count;
+		s_NextIndex = 0;
+		s_BusyWorkers = static_cast<u32>(s_Workers.size());
+		s_JobGeneration++;
+	}
+	s_WakeUp.notify_all();
+
+	RunJob();
+
+	std::unique_lock lock(s_Mutex);
+	s_Finished.wait(lock, [] { return s_BusyWorkers == 0; });
+	s_Job = nullptr;
+}
+
+u32 JobSystem::WorkerCount() {
+	return static_cast<u32>(s_Workers.size());
+}
+
+u32 JobSystem::DefaultWorkerCount() {
+	const u32 hardwareThreads = std::thread::hardware_concurrency();
+	return hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+}
+
+// The starting generation is taken on the main thread, a worker that starts late still sees a job issued
+// right after Init as new
+void JobSystem::WorkerLoop(u64 lastGeneration) {
+	while (true) {
+		{
+			std::unique_lock lock(s_Mutex);
+			s_WakeUp.wait(lock, [&] { return s_Quit || s_JobGeneration != lastGeneration; });
+			if (s_Quit) return;
+			lastGeneration = s_JobGeneration;
+		}
+
+		RunJob();
+
+		std::lock_guard lock(s_Mutex);
+		if (--s_BusyWorkers == 0) {
+			s_Finished.notify_one();
+		}
+	}
+}
+
+void JobSystem::RunJob() {
+	for (u32 index = s_NextIndex++; index < s_JobCount; index = s_NextIndex++) {
+		(*s_Job)(index);
+	}
+}
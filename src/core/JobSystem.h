@@ -0,0 +1,41 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Base.h"
+
+// Fixed pool of worker threads that split index ranges between themselves and the calling thread.
+// Only one ParallelFor runs at a time and it must be issued from the main thread.
+class JobSystem {
+public:
+	// Defaults to one worker per hardware thread besides the main thread
+	static void Init(u32 workerCount = DefaultWorkerCount());
+	static void Shutdown();
+
+	// Calls func(index) for every index in [0, count) and returns once all calls have finished.
+	// Indices are handed out one at a time, so each call should carry a reasonable amount of work.
+	static void ParallelFor(u32 count, const std::function<void(u32)>& func);
+
+	static u32 WorkerCount();
+	static u32 DefaultWorkerCount();
+private:
+	static void WorkerLoop(u64 lastGeneration);
+	static void RunJob();
+private:
+	inline static std::vector<std::thread> s_Workers;
+	inline static std::mutex s_Mutex;
+	inline static std::condition_variable s_WakeUp;
+	inline static std::condition_variable s_Finished;
+
+	inline static const std::function<void(u32)>* s_Job = nullptr;
+	inline static u32 s_JobCount = 0;
+	inline static std::atomic<u32> s_NextIndex = 0;
+
+	// Bumped for every job so sleeping workers can tell a new job from a spurious wake up
+	inline static u64 s_JobGeneration = 0;
+	inline static u32 s_BusyWorkers = 0;
+	inline static bool s_Quit = false;
+};
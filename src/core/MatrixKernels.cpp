@@ -0,0 +1,275 @@
+#include "Components.h"
+#include "MatrixKernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define MATRIX_KERNELS_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define MATRIX_KERNELS_AVX2
+#else
+#define MATRIX_KERNELS_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace {
+
+using ComposeKernel = void (*)(u32 count, const Transform* const* transforms, AffineMatrix* const* matrices);
+using MultiplyKernel = void (*)(u32 count, const AffineMatrix* const* parents, const AffineMatrix* locals, AffineMatrix* results);
+
+struct KernelTable {
+	ComposeKernel compose;
+	MultiplyKernel multiply;
+	const char* name;
+};
+
+void ComposeScalar(const u32 count, const Transform* const* transforms, AffineMatrix* const* matrices) {
+	for (u32 i = 0; i < count; i++) {
+		*matrices[i] = MatrixKernels::Compose(transforms[i]->position, transforms[i]->rotation, transforms[i]->scale);
+	}
+}
+
+void MultiplyScalar(const u32 count, const AffineMatrix* const* parents, const AffineMatrix* locals, AffineMatrix* results) {
+	for (u32 i = 0; i < count; i++) {
+		results[i] = *parents[i] * locals[i];
+	}
+}
+
+#ifdef MATRIX_KERNELS_X86
+// Position, rotation and scale of Lanes transforms, one row per float so each row loads as a vector
+enum TransformField { PX, PY, PZ, QX, QY, QZ, QW, SX, SY, SZ, TransformFieldCount };
+
+template<u32 Lanes>
+void GatherTransforms(const Transform* const* transforms, f32 (&fields)[TransformFieldCount][Lanes]) {
+	for (u32 lane = 0; lane < Lanes; lane++) {
+		const Transform& trans = *transforms[lane];
+		fields[PX][lane] = trans.position.x;
+		fields[PY][lane] = trans.position.y;
+		fields[PZ][lane] = trans.position.z;
+		fields[QX][lane] = trans.rotation.x;
+		fields[QY][lane] = trans.rotation.y;
+		fields[QZ][lane] = trans.rotation.z;
+		fields[QW][lane] = trans.rotation.w;
+		fields[SX][lane] = trans.scale.x;
+		fields[SY][lane] = trans.scale.y;
+		fields[SZ][lane] = trans.scale.z;
+	}
+}
+
+void ComposeSSE(const u32 count, const Transform* const* transforms, AffineMatrix* const* matrices) {
+	u32 i = 0;
+	for (; i + 4 <= count; i += 4) {
+		alignas(16) f32 fields[TransformFieldCount][4];
+		GatherTransforms<4>(transforms + i, fields);
+
+		const __m128 x = _mm_load_ps(fields[QX]), y = _mm_load_ps(fields[QY]), z = _mm_load_ps(fields[QZ]), w = _mm_load_ps(fields[QW]);
+		const __m128 one = _mm_set1_ps(1.0f), two = _mm_set1_ps(2.0f);
+
+		const __m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+		const __m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+		const __m128 wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+
+		const __m128 sx = _mm_load_ps(fields[SX]), sy = _mm_load_ps(fields[SY]), sz = _mm_load_ps(fields[SZ]);
+
+		// One register per matrix element, lane n belongs to transform n
+		__m128 m00 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx);
+		__m128 m01 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), sy);
+		__m128 m02 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), sz);
+		__m128 m03 = _mm_load_ps(fields[PX]);
+
+		__m128 m10 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), sx);
+		__m128 m11 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy);
+		__m128 m12 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), sz);
+		__m128 m13 = _mm_load_ps(fields[PY]);
+
+		__m128 m20 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), sx);
+		__m128 m21 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), sy);
+		__m128 m22 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz);
+		__m128 m23 = _mm_load_ps(fields[PZ]);
+
+		// Transposing turns the four registers of a row into that row of each of the four matrices
+		_MM_TRANSPOSE4_PS(m00, m01, m02, m03);
+		_MM_TRANSPOSE4_PS(m10, m11, m12, m13);
+		_MM_TRANSPOSE4_PS(m20, m21, m22, m23);
+
+		const __m128 rows[4][3] = { { m00, m10, m20 }, { m01, m11, m21 }, { m02, m12, m22 }, { m03, m13, m23 } };
+		for (u32 lane = 0; lane < 4; lane++) {
+			f32* out = &matrices[i + lane]->rows[0][0];
+			for (u32 row = 0; row < 3; row++) {
+				_mm_storeu_ps(out + row * 4, rows[lane][row]);
+			}
+		}
+	}
+
+	ComposeScalar(count - i, transforms + i, matrices + i);
+}
+
+// a.x * b0 + a.y * b1 + a.z * b2 + (0, 0, 0, a.w), one row of an affine product
+inline __m128 CombineRows(const __m128 a, const __m128 b0, const __m128 b1, const __m128 b2, const __m128 wMask) {
+	__m128 result = _mm_mul_ps(b0, _mm_shuffle_ps(a, a, 0x00));
+	result = _mm_add_ps(result, _mm_mul_ps(b1, _mm_shuffle_ps(a, a, 0x55)));
+	result = _mm_add_ps(result, _mm_mul_ps(b2, _mm_shuffle_ps(a, a, 0xAA)));
+	return _mm_add_ps(result, _mm_and_ps(a, wMask));
+}
+
+void MultiplySSE(const u32 count, const AffineMatrix* const* parents, const AffineMatrix* locals, AffineMatrix* results) {
+	const __m128 wMask = _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1));
+
+	for (u32 i = 0; i < count; i++) {
+		const f32* a = parents[i]->Data();
+		const f32* b = locals[i].Data();
+
+		// Everything is loaded before the first store in case the result overwrites one of the inputs
+		const __m128 a0 = _mm_loadu_ps(a), a1 = _mm_loadu_ps(a + 4), a2 = _mm_loadu_ps(a + 8);
+		const __m128 b0 = _mm_loadu_ps(b), b1 = _mm_loadu_ps(b + 4), b2 = _mm_loadu_ps(b + 8);
+
+		f32* out = &results[i].rows[0][0];
+		_mm_storeu_ps(out, CombineRows(a0, b0, b1, b2, wMask));
+		_mm_storeu_ps(out + 4, CombineRows(a1, b0, b1, b2, wMask));
+		_mm_storeu_ps(out + 8, CombineRows(a2, b0, b1, b2, wMask));
+	}
+}
+
+MATRIX_KERNELS_AVX2 void ComposeAVX2(const u32 count, const Transform* const* transforms, AffineMatrix* const* matrices) {
+	u32 i = 0;
+	for (; i + 8 <= count; i += 8) {
+		alignas(32) f32 fields[TransformFieldCount][8];
+		GatherTransforms<8>(transforms + i, fields);
+
+		const __m256 x = _mm256_load_ps(fields[QX]), y = _mm256_load_ps(fields[QY]), z = _mm256_load_ps(fields[QZ]), w = _mm256_load_ps(fields[QW]);
+		const __m256 one = _mm256_set1_ps(1.0f), two = _mm256_set1_ps(2.0f);
+
+		const __m256 xx = _mm256_mul_ps(x, x), yy = _mm256_mul_ps(y, y), zz = _mm256_mul_ps(z, z);
+		const __m256 xy = _mm256_mul_ps(x, y), xz = _mm256_mul_ps(x, z), yz = _mm256_mul_ps(y, z);
+		const __m256 wx = _mm256_mul_ps(w, x), wy = _mm256_mul_ps(w, y), wz = _mm256_mul_ps(w, z);
+
+		const __m256 sx = _mm256_load_ps(fields[SX]), sy = _mm256_load_ps(fields[SY]), sz = _mm256_load_ps(fields[SZ]);
+
+		const __m256 elements[3][4] = {
+			{
+				_mm256_mul_ps(_mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(yy, zz))), sx),
+				_mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(xy, wz)), sy),
+				_mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(xz, wy)), sz),
+				_mm256_load_ps(fields[PX])
+			},
+			{
+				_mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(xy, wz)), sx),
+				_mm256_mul_ps(_mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(xx, zz))), sy),
+				_mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(yz, wx)), sz),
+				_mm256_load_ps(fields[PY])
+			},
+			{
+				_mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(xz, wy)), sx),
+				_mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(yz, wx)), sy),
+				_mm256_mul_ps(_mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(xx, yy))), sz),
+				_mm256_load_ps(fields[PZ])
+			}
+		};
+
+		// Same transpose as the SSE version within each 128 bit half, the low half holds the rows of
+		// transforms 0-3 and the high half those of transforms 4-7
+		for (u32 row = 0; row < 3; row++) {
+			const __m256* e = elements[row];
+			const __m256 t0 = _mm256_unpacklo_ps(e[0], e[1]), t1 = _mm256_unpackhi_ps(e[0], e[1]);
+			const __m256 t2 = _mm256_unpacklo_ps(e[2], e[3]), t3 = _mm256_unpackhi_ps(e[2], e[3]);
+			const __m256 lanes[4] = {
+				_mm256_shuffle_ps(t0, t2, 0x44), _mm256_shuffle_ps(t0, t2, 0xEE),
+				_mm256_shuffle_ps(t1, t3, 0x44), _mm256_shuffle_ps(t1, t3, 0xEE)
+			};
+
+			for (u32 lane = 0; lane < 4; lane++) {
+				_mm_storeu_ps(&matrices[i + lane]->rows[row][0], _mm256_castps256_ps128(lanes[lane]));
+				_mm_storeu_ps(&matrices[i + lane + 4]->rows[row][0], _mm256_extractf128_ps(lanes[lane], 1));
+			}
+		}
+	}
+
+	ComposeSSE(count - i, transforms + i, matrices + i);
+}
+
+// Rows 0 and 1 of the result at once, the local matrix's rows are repeated in both halves. Row 2 goes through SSE.
+MATRIX_KERNELS_AVX2 void MultiplyAVX2(const u32 count, const AffineMatrix* const* parents, const AffineMatrix* locals, AffineMatrix* results) {
+	const __m128 wMask = _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1));
+	const __m256 wMask2 = _mm256_castsi256_ps(_mm256_setr_epi32(0, 0, 0, -1, 0, 0, 0, -1));
+
+	for (u32 i = 0; i < count; i++) {
+		const f32* a = parents[i]->Data();
+		const f32* b = locals[i].Data();
+
+		const __m256 a01 = _mm256_loadu_ps(a);
+		const __m128 a2 = _mm_loadu_ps(a + 8);
+		const __m128 b0 = _mm_loadu_ps(b), b1 = _mm_loadu_ps(b + 4), b2 = _mm_loadu_ps(b + 8);
+		const __m256 b0x2 = _mm256_broadcast_ps(&b0), b1x2 = _mm256_broadcast_ps(&b1), b2x2 = _mm256_broadcast_ps(&b2);
+
+		__m256 r01 = _mm256_mul_ps(b0x2, _mm256_permute_ps(a01, 0x00));
+		r01 = _mm256_add_ps(r01, _mm256_mul_ps(b1x2, _mm256_permute_ps(a01, 0x55)));
+		r01 = _mm256_add_ps(r01, _mm256_mul_ps(b2x2, _mm256_permute_ps(a01, 0xAA)));
+		r01 = _mm256_add_ps(r01, _mm256_and_ps(a01, wMask2));
+		const __m128 r2 = CombineRows(a2, b0, b1, b2, wMask);
+
+		f32* out = &results[i].rows[0][0];
+		_mm256_storeu_ps(out, r01);
+		_mm_storeu_ps(out + 8, r2);
+	}
+}
+
+bool SupportsAVX2() {
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7) return false;
+
+	// The OS has to save the upper halves of the ymm registers too
+	__cpuid(info, 1);
+	const bool osSavesAVX = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+	if (!osSavesAVX) return false;
+
+	__cpuidex(info, 7, 0);
+	return info[1] & (1 << 5);
+#else
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+KernelTable SelectKernels() {
+#ifdef MATRIX_KERNELS_X86
+	if (SupportsAVX2()) {
+		return { ComposeAVX2, MultiplyAVX2, "AVX2" };
+	}
+	return { ComposeSSE, MultiplySSE, "SSE" };
+#else
+	return { ComposeScalar, MultiplyScalar, "Scalar" };
+#endif
+}
+
+const KernelTable& Kernels() {
+	static const KernelTable kernels = SelectKernels();
+	return kernels;
+}
+
+}
+
+AffineMatrix MatrixKernels::Compose(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale) {
+	const f32 xx = rotation.x * rotation.x, yy = rotation.y * rotation.y, zz = rotation.z * rotation.z;
+	const f32 xy = rotation.x * rotation.y, xz = rotation.x * rotation.z, yz = rotation.y * rotation.z;
+	const f32 wx = rotation.w * rotation.x, wy = rotation.w * rotation.y, wz = rotation.w * rotation.z;
+
+	AffineMatrix matrix;
+	matrix.rows[0] = glm::vec4((1.0f - 2.0f * (yy + zz)) * scale.x, (2.0f * (xy - wz)) * scale.y, (2.0f * (xz + wy)) * scale.z, position.x);
+	matrix.rows[1] = glm::vec4((2.0f * (xy + wz)) * scale.x, (1.0f - 2.0f * (xx + zz)) * scale.y, (2.0f * (yz - wx)) * scale.z, position.y);
+	matrix.rows[2] = glm::vec4((2.0f * (xz - wy)) * scale.x, (2.0f * (yz + wx)) * scale.y, (1.0f - 2.0f * (xx + yy)) * scale.z, position.z);
+	return matrix;
+}
+
+void MatrixKernels::ComposeMany(const u32 count, const Transform* const* transforms, AffineMatrix* const* matrices) {
+	Kernels().compose(count, transforms, matrices);
+}
+
+void MatrixKernels::MultiplyMany(const u32 count, const AffineMatrix* const* parents, const AffineMatrix* locals, AffineMatrix* results) {
+	Kernels().multiply(count, parents, locals, results);
+}
+
+const char* MatrixKernels::InstructionSet() {
+	return Kernels().name;
+}
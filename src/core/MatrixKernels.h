@@ -0,0 +1,25 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <glm/gtx/quaternion.hpp>
+#include "AffineMatrix.h"
+#include "Base.h"
+
+struct Transform;
+
+// Batched matrix math for the transform hierarchy. Every kernel has a scalar, SSE and AVX2 version and the
+// widest one the CPU supports is picked the first time a kernel runs. All versions perform the same float
+// operations in the same order as the scalar one.
+class MatrixKernels {
+public:
+	// translate(position) * mat4_cast(rotation) * scale(scale), without the full matrix multiplies
+	static AffineMatrix Compose(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale);
+
+	// *matrices[i] = Compose(*transforms[i]). Transforms are converted 4 or 8 at a time.
+	static void ComposeMany(u32 count, const Transform* const* transforms, AffineMatrix* const* matrices);
+
+	// results[i] = *parents[i] * locals[i], computed in order. A parent may point at an earlier result of
+	// the same call, which is how a whole depth first ordered hierarchy is updated in one call.
+	static void MultiplyMany(u32 count, const AffineMatrix* const* parents, const AffineMatrix* locals, AffineMatrix* results);
+
+	static const char* InstructionSet();
+};
@@ -0,0 +1,73 @@
+#include "SystemScheduler.h"
+#include <algorithm>
+#include "JobSystem.h"
+
+SystemScheduler::System& SystemScheduler::Add(std::string name, std::function<void(Registry&)> update) {
+	Scope<System> system = MakeScope<System>();
+	system->m_Name = std::move(name);
+	system->m_Update = std::move(update);
+	m_Systems.push_back(std::move(system));
+	m_StagesDirty = true;
+	return *m_Systems.back();
+}
+
+void SystemScheduler::Run(Registry& registry) {
+	if (m_StagesDirty) {
+		BuildStages();
+	}
+
+	for (const Stage& stage : m_Stages) {
+		// Views repack dirty archetypes when they begin, which must not happen while other systems iterate
+		registry.RefreshArchetypes();
+
+		JobSystem::ParallelFor(static_cast<u32>(stage.workerSystems.size()), [&](const u32 i) {
+			m_Systems[stage.workerSystems[i]]->m_Update(registry);
+		});
+
+		// Sync point, no worker touches the registry anymore so their structural changes can be applied
+		m_CommandBuffer.Playback(registry);
+
+		for (const u32 index : stage.mainThreadSystems) {
+			m_Systems[index]->m_Update(registry);
+		}
+	}
+
+	m_CommandBuffer.Playback(registry);
+}
+
+bool SystemScheduler::Conflicts(const System& first, const System& second) {
+	if (first.m_MainThread && second.m_MainThread) return true;
+	return first.m_Writes.SharesAnyWith(second.m_Reads) ||
+		first.m_Writes.SharesAnyWith(second.m_Writes) ||
+		first.m_Reads.SharesAnyWith(second.m_Writes);
+}
+
+// Systems are visited in the order they were added, so every edge points at an earlier system and the
+// graph can't have cycles. A system's stage is one past the latest stage of anything it depends on.
+void SystemScheduler::BuildStages() {
+	std::vector<u32> stageOf(m_Systems.size(), 0);
+	m_Stages.clear();
+
+	for (u32 i = 0; i < m_Systems.size(); i++) {
+		const System& system = *m_Systems[i];
+
+		u32 stage = 0;
+		for (u32 j = 0; j < i; j++) {
+			if (Conflicts(*m_Systems[j], system)) {
+				stage = std::max(stage, stageOf[j] + 1);
+			}
+		}
+		stageOf[i] = stage;
+
+		if (stage >= m_Stages.size()) {
+			m_Stages.resize(stage + 1);
+		}
+		if (system.m_MainThread) {
+			m_Stages[stage].mainThreadSystems.push_back(i);
+		} else {
+			m_Stages[stage].workerSystems.push_back(i);
+		}
+	}
+
+	m_StagesDirty = false;
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <functional>
+#include <string>
+#include <vector>
+#include "Base.h"
+#include "ecs/Registry.h"
+#include "ecs/EntityCommandBuffer.h"
+
+// Runs a list of systems once per frame. Every system declares the components it reads and writes, two
+// systems conflict when one of them writes a component the other touches. Conflicting systems keep the
+// order they were added in, the rest are grouped into stages whose systems run at the same time on the
+// JobSystem's workers. Systems running on a worker must not add, remove or destroy anything, structural
+// changes are recorded into CommandBuffer() instead and applied once the stage's workers are done. They also must not be the first to ask the registry for a
+// group, creating one isn't thread safe, so groups they use are created from the main thread beforehand.
+class SystemScheduler {
+public:
+	class System {
+	public:
+		template<typename... Components>
+		System& Reads() {
+			(m_Reads.Set(Registry::GetComponentId<Components>()), ...);
+			return *this;
+		}
+
+		template<typename... Components>
+		System& Writes() {
+			(m_Writes.Set(Registry::GetComponentId<Components>()), ...);
+			return *this;
+		}
+
+		// For systems touching GL, the window or other global state, or issuing their own ParallelFor.
+		// They run on the thread calling Run and keep their order relative to each other.
+		System& MainThread() {
+			m_MainThread = true;
+			return *this;
+		}
+
+		const std::string& Name() const { return m_Name; }
+	private:
+		friend class SystemScheduler;
+
+		std::string m_Name;
+		std::function<void(Registry&)> m_Update;
+		EntityCompMask m_Reads;
+		EntityCompMask m_Writes;
+		bool m_MainThread = false;
+	};
+
+	// The returned system is used to declare its components and stays valid for the scheduler's lifetime
+	System& Add(std::string name, std::function<void(Registry&)> update);
+
+	// Runs every system once, must be called from the main thread
+	void Run(Registry& registry);
+
+	// Shared by every system, recording is thread safe. Played back after the worker systems of each stage
+	// and once more at the end of Run for anything main thread systems recorded.
+	EntityCommandBuffer& CommandBuffer() { return m_CommandBuffer; }
+private:
+	struct Stage {
+		std::vector<u32> workerSystems;
+		std::vector<u32> mainThreadSystems;
+	};
+
+	static bool Conflicts(const System& first, const System& second);
+	void BuildStages();
+private:
+	std::vector<Scope<System>> m_Systems;
+	std::vector<Stage> m_Stages;
+	EntityCommandBuffer m_CommandBuffer;
+
+	// Declarations can change after Add returns, so the graph is built on the first Run after a change
+	bool m_StagesDirty = true;
+};
@@ -1,32 +1,283 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include "Components.h"
+#include "JobSystem.h"
+#include "MatrixKernels.h"
 #include "ecs/View.h"
 #include "TransformSystem.h"
 
 void TransformSystem::Update(Registry& registry) {
-	 auto rootView = View<LocalToWorld, Transform, Children>(registry).Exclude<Parent>();
-	for (const Entity entity : rootView) {
-		UpdateLocalToWorld(registry, entity);
+	const auto startTime = std::chrono::steady_clock::now();
+
+	const bool rebuild = registry.GetId() != s_RegistryId || registry.GetStructureVersion() > s_LastUpdateVersion;
+	if (rebuild) {
+		AddNormalMatrices(registry);
+		RebuildHierarchy(registry);
+	}
+
+	const UpdateContext context {
+		registry.GetPool<Transform>(), registry.GetPool<LocalToWorld>(), registry.GetPool<NormalMatrix>(), registry.GetVersion()
+	};
+	s_UpdatedCount = 0;
+
+	if (rebuild) {
+		s_UpdatedCount += BakeStaticNodes(context);
+	}
+#ifndef NDEBUG
+	else {
+		ValidateStaticNodes(context);
+	}
+#endif
+
+	for (const u32 node : s_UpperNodes) {
+		const u32 parent = s_Parents[node];
+		const bool changed = (parent != NoParent && s_WorldChanged[parent]) || IsDirty(context, node);
+
+		s_WorldChanged[node] = changed;
+		if (changed) {
+			UpdateRange(context, node, node + 1);
+			s_UpdatedCount++;
+		}
+	}
+
+	// Batches only read the upper nodes' matrices and write their own nodes, so they can run in any order
+	std::atomic<u32> batchUpdatedCount = 0;
+	JobSystem::ParallelFor(static_cast<u32>(s_Batches.size()), [&context, &batchUpdatedCount](const u32 batch) {
+		u32 updatedCount = 0;
+		for (u32 subtree = s_Batches[batch].begin; subtree < s_Batches[batch].end; subtree++) {
+			updatedCount += UpdateSubtree(context, s_Subtrees[subtree]);
+		}
+		batchUpdatedCount += updatedCount;
+	});
+
+	s_UpdatedCount += batchUpdatedCount;
+	s_LastUpdateVersion = registry.AdvanceVersion();
+
+	const std::chrono::duration<f32, std::milli> updateTime = std::chrono::steady_clock::now() - startTime;
+	s_UpdateMilliseconds = updateTime.count();
+}
+
+// Runs right after a rebuild while every node is dirty, static nodes are never touched again until the next one
+u32 TransformSystem::BakeStaticNodes(const UpdateContext& context) {
+	const u32 nodeCount = static_cast<u32>(s_Parents.size());
+	u32 bakedCount = 0;
+
+	u32 node = 0;
+	while (node < nodeCount) {
+		if (!s_Static[node]) {
+			node++;
+			continue;
+		}
+
+		const u32 runBegin = node;
+		while (node < nodeCount && s_Static[node]) {
+			node++;
+		}
+
+		UpdateRange(context, runBegin, node);
+		bakedCount += node - runBegin;
+	}
+
+	return bakedCount;
+}
+
+void TransformSystem::ValidateStaticNodes(const UpdateContext& context) {
+	for (const u32 node : s_StaticNodes) {
+		ASSERT(context.transforms->VersionAtDense(s_TransformIndices[node]) <= s_LastUpdateVersion,
+		       "Transform of a static entity was changed, remove Static before moving it");
+	}
+}
+
+bool TransformSystem::IsDirty(const UpdateContext& context, const u32 node) {
+	return s_Dirty[node] || context.transforms->VersionAtDense(s_TransformIndices[node]) > s_LastUpdateVersion;
+}
+
+// Recomputes every node in [begin, end). Parents outside the range must already be up to date, those inside
+// come before their children and are finished by the multiply kernel before it reaches them.
+void TransformSystem::UpdateRange(const UpdateContext& context, const u32 begin, const u32 end) {
+	static const AffineMatrix identity;
+
+	const Transform* transforms[KernelBatchSize];
+	AffineMatrix* locals[KernelBatchSize];
+	const AffineMatrix* parents[KernelBatchSize];
+
+	for (u32 first = begin; first < end; first += KernelBatchSize) {
+		const u32 count = std::min(end - first, KernelBatchSize);
+
+		u32 dirtyCount = 0;
+		for (u32 node = first; node < first + count; node++) {
+			if (!IsDirty(context, node)) continue;
+
+			transforms[dirtyCount] = static_cast<const Transform*>(context.transforms->GetDenseAddress(s_TransformIndices[node]));
+			locals[dirtyCount] = &s_LocalMatrices[node];
+			dirtyCount++;
+			s_Dirty[node] = false;
+		}
+		MatrixKernels::ComposeMany(dirtyCount, transforms, locals);
+
+		for (u32 node = first; node < first + count; node++) {
+			const u32 parent = s_Parents[node];
+			parents[node - first] = parent == NoParent ? &identity : &s_WorldMatrices[parent];
+		}
+		MatrixKernels::MultiplyMany(count, parents, &s_LocalMatrices[first], &s_WorldMatrices[first]);
+
+		for (u32 node = first; node < first + count; node++) {
+			const u32 toWorldIndex = s_LocalToWorldIndices[node];
+			static_cast<LocalToWorld*>(context.toWorlds->GetDenseAddress(toWorldIndex))->matrix = s_WorldMatrices[node];
+			context.toWorlds->SetVersionAtDense(toWorldIndex, context.version);
+
+			// Only ever recomputed together with the world matrix, so the vertex shader never inverts anything
+			const u32 normalIndex = s_NormalMatrixIndices[node];
+			if (normalIndex != NoIndex) {
+				static_cast<NormalMatrix*>(context.normals->GetDenseAddress(normalIndex))->matrix = s_WorldMatrices[node].InverseTranspose();
+				context.normals->SetVersionAtDense(normalIndex, context.version);
+			}
+		}
 	}
 }
 
-void TransformSystem::UpdateLocalToWorld(Registry& registry, const Entity entity) {
-	auto& toWorld = registry.Get<LocalToWorld>(entity);
-	auto& trans = registry.Get<Transform>(entity);
+// Clean nodes are skipped one by one. A dirty node recomputes its whole subtree, which directly follows it,
+// and since parents come first every parent matrix read inside the subtree is already up to date.
+u32 TransformSystem::UpdateSubtree(const UpdateContext& context, const NodeRange& subtree) {
+	const u32 parent = s_Parents[subtree.begin];
+	const bool parentChanged = parent != NoParent && s_WorldChanged[parent];
+	u32 updatedCount = 0;
+
+	u32 node = subtree.begin;
+	while (node < subtree.end) {
+		if (!(node == subtree.begin && parentChanged) && !IsDirty(context, node)) {
+			node++;
+			continue;
+		}
+
+		const u32 subtreeEnd = node + s_SubtreeSizes[node];
+		updatedCount += s_SubtreeSizes[node];
 
-	toWorld.matrix = glm::translate(glm::mat4(1.0f), trans.position);
-	toWorld.matrix = toWorld.matrix * glm::mat4_cast(trans.rotation);
-	toWorld.matrix = glm::scale(toWorld.matrix, trans.scale);
+		UpdateRange(context, node, subtreeEnd);
+		node = subtreeEnd;
+	}
 
-	if (registry.Has<Parent>(entity)) {
-		auto& parent = registry.Get<Parent>(entity);
-		auto& parentLTW = registry.Get<LocalToWorld>(parent.entity);
-		toWorld.matrix = parentLTW.matrix * toWorld.matrix;
+	return updatedCount;
+}
+
+// Every rendered entity needs a NormalMatrix, giving it one here means nothing else has to remember to add it.
+// Only runs on rebuilds since gaining a MeshRenderer is a structural change.
+void TransformSystem::AddNormalMatrices(Registry& registry) {
+	std::vector<Entity> missing;
+	for (const Entity entity : View<MeshRenderer, LocalToWorld, Transform>(registry).Exclude<NormalMatrix>()) {
+		missing.push_back(entity);
 	}
 
-	if (registry.Has<Children>(entity)) {
-		auto& children = registry.Get<Children>(entity);
-		for (auto& childEntity : children.entities) {
-			UpdateLocalToWorld(registry, childEntity);
+	for (const Entity entity : missing) {
+		registry.Add<NormalMatrix>(entity);
+	}
+}
+
+void TransformSystem::RebuildHierarchy(Registry& registry) {
+	s_RegistryId = registry.GetId();
+	s_Parents.clear();
+	s_SubtreeSizes.clear();
+	s_TransformIndices.clear();
+	s_LocalToWorldIndices.clear();
+	s_NormalMatrixIndices.clear();
+	s_Static.clear();
+	s_StaticNodes.clear();
+
+	// Iterating a view repacks archetype registries first, so the dense indices recorded below stay valid
+	const auto view = View<LocalToWorld, Transform>(registry);
+	ComponentPool* transforms = registry.GetPool<Transform>();
+	ComponentPool* toWorlds = registry.GetPool<LocalToWorld>();
+	ComponentPool* normals = registry.GetPool<NormalMatrix>();
+
+	std::vector<std::pair<Entity, u32>> stack;
+	for (const Entity root : view) {
+		if (registry.Has<Parent>(root) && IsNode(registry, registry.Read<Parent>(root).entity)) continue;
+
+		stack.emplace_back(root, NoParent);
+		while (!stack.empty()) {
+			const auto [entity, parent] = stack.back();
+			stack.pop_back();
+
+			const u32 node = static_cast<u32>(s_Parents.size());
+			s_Parents.push_back(parent);
+			s_SubtreeSizes.push_back(1);
+			s_TransformIndices.push_back(static_cast<u32>(transforms->DenseIndexOf(entity.Id())));
+			s_LocalToWorldIndices.push_back(static_cast<u32>(toWorlds->DenseIndexOf(entity.Id())));
+			s_NormalMatrixIndices.push_back(registry.Has<NormalMatrix>(entity) ? static_cast<u32>(normals->DenseIndexOf(entity.Id())) : NoIndex);
+
+			const bool isStatic = registry.Has<Static>(entity);
+			ASSERT(!isStatic || parent == NoParent || s_Static[parent], "Static entity " << entity.Id() << " has a parent that can move");
+			s_Static.push_back(isStatic);
+			if (isStatic) {
+				s_StaticNodes.push_back(node);
+			}
+
+			if (!registry.Has<Children>(entity)) continue;
+
+			// Pushed in reverse so children are laid out in the order they are listed
+			const auto& children = registry.Read<Children>(entity).entities;
+			for (auto child = children.rbegin(); child != children.rend(); ++child) {
+				if (IsNode(registry, *child)) {
+					stack.emplace_back(*child, node);
+				}
+			}
 		}
 	}
+
+	// Children always follow their parent, so walking backwards finishes every subtree before its root
+	for (size_t node = s_Parents.size(); node-- > 0;) {
+		if (s_Parents[node] != NoParent) {
+			s_SubtreeSizes[s_Parents[node]] += s_SubtreeSizes[node];
+		}
+	}
+
+	s_LocalMatrices.resize(s_Parents.size());
+	s_WorldMatrices.resize(s_Parents.size());
+	s_Dirty.assign(s_Parents.size(), true);
+	s_WorldChanged.assign(s_Parents.size(), false);
+
+	PartitionHierarchy();
+}
+
+// Splits the node array into subtrees of at most BatchSize nodes. Nodes above them are too big to hand to
+// a single worker and are few in practice, every subtree's parent is either one of them, a static node or none.
+void TransformSystem::PartitionHierarchy() {
+	s_UpperNodes.clear();
+	s_Subtrees.clear();
+	s_Batches.clear();
+
+	const u32 nodeCount = static_cast<u32>(s_Parents.size());
+	u32 batchNodeCount = 0;
+
+	u32 node = 0;
+	while (node < nodeCount) {
+		// Descendants that aren't static are picked up one by one as the walk continues
+		if (s_Static[node]) {
+			node++;
+			continue;
+		}
+
+		const u32 subtreeSize = s_SubtreeSizes[node];
+		if (subtreeSize > BatchSize) {
+			s_UpperNodes.push_back(node);
+			node++;
+			continue;
+		}
+
+		if (s_Batches.empty() || batchNodeCount >= BatchSize) {
+			const u32 firstSubtree = static_cast<u32>(s_Subtrees.size());
+			s_Batches.push_back({ firstSubtree, firstSubtree });
+			batchNodeCount = 0;
+		}
+
+		s_Subtrees.push_back({ node, node + subtreeSize });
+		s_Batches.back().end++;
+		batchNodeCount += subtreeSize;
+		node += subtreeSize;
+	}
+}
+
+bool TransformSystem::IsNode(Registry& registry, const Entity entity) {
+	return registry.IsValid(entity) && registry.Has<Transform>(entity) && registry.Has<LocalToWorld>(entity);
 }
@@ -1,10 +1,89 @@
 #pragma once
+#include <vector>
+#include "AffineMatrix.h"
 #include "ecs/Registry.h"
 
 class TransformSystem {
 public:
+	// Subtrees are spread over the JobSystem's workers, the result is identical to a serial update.
+	// Static entities are only computed after the hierarchy changed and cost nothing otherwise.
 	static void Update(Registry& registry);
+
+	// Number of world matrices recomputed by the last update, zero for a scene where nothing moved
+	static u32 GetUpdatedCount() { return s_UpdatedCount; }
+
+	// Wall time of the last update including the hierarchy rebuild, for comparing worker counts
+	static f32 GetUpdateMilliseconds() { return s_UpdateMilliseconds; }
 private:
-	static void UpdateLocalToWorld(Registry& registry, const Entity entity);
-};
+	struct UpdateContext {
+		ComponentPool* transforms;
+		ComponentPool* toWorlds;
+		ComponentPool* normals;
+		u32 version;
+	};
+
+	struct NodeRange {
+		u32 begin;
+		u32 end;
+	};
+
+	static void AddNormalMatrices(Registry& registry);
+	static void RebuildHierarchy(Registry& registry);
+	static void PartitionHierarchy();
+	static bool IsNode(Registry& registry, const Entity entity);
+
+	static u32 BakeStaticNodes(const UpdateContext& context);
+	static void ValidateStaticNodes(const UpdateContext& context);
+
+	static bool IsDirty(const UpdateContext& context, const u32 node);
+	static void UpdateRange(const UpdateContext& context, const u32 begin, const u32 end);
+	static u32 UpdateSubtree(const UpdateContext& context, const NodeRange& subtree);
+private:
+	static constexpr u32 NoParent = static_cast<u32>(-1);
+	static constexpr u32 NoIndex = static_cast<u32>(-1);
+
+	// Subtrees up to this many nodes are updated as a whole by one worker, and neighbouring
+	// subtrees are grouped into batches of roughly this size
+	static constexpr u32 BatchSize = 1024;
+
+	// Nodes handed to the matrix kernels per call
+	static constexpr u32 KernelBatchSize = 64;
 
+	// Every entity with a Transform and LocalToWorld in depth first order. A node's parent always comes
+	// before it and its descendants are the s_SubtreeSizes[node] - 1 nodes directly after it.
+	inline static std::vector<u32> s_Parents;
+	inline static std::vector<u32> s_SubtreeSizes;
+
+	// Dense indices into the Transform and LocalToWorld pools, valid until the registry's structure changes
+	inline static std::vector<u32> s_TransformIndices;
+	inline static std::vector<u32> s_LocalToWorldIndices;
+
+	// Dense index into the NormalMatrix pool, NoIndex for nodes without one
+	inline static std::vector<u32> s_NormalMatrixIndices;
+
+	// Local and world matrices in node order so parents are read from the same array instead of the registry
+	inline static std::vector<AffineMatrix> s_LocalMatrices;
+	inline static std::vector<AffineMatrix> s_WorldMatrices;
+
+	// Set for every node after a rebuild, otherwise a node is dirty when its Transform was written since the last update
+	inline static std::vector<u8> s_Dirty;
+
+	// Static nodes are left out of the partition below. Since their parents are static too, they form runs
+	// of nodes starting at roots, which are computed once after every rebuild.
+	inline static std::vector<u8> s_Static;
+	inline static std::vector<u32> s_StaticNodes;
+
+	// Nodes whose subtree is larger than a batch, updated in order on the calling thread before the batches run.
+	// s_WorldChanged tells the subtrees below them whether they have to be recomputed.
+	inline static std::vector<u32> s_UpperNodes;
+	inline static std::vector<u8> s_WorldChanged;
+
+	// Independent subtrees, and the ranges of s_Subtrees making up each batch
+	inline static std::vector<NodeRange> s_Subtrees;
+	inline static std::vector<NodeRange> s_Batches;
+
+	inline static u32 s_RegistryId = static_cast<u32>(-1);
+	inline static u32 s_LastUpdateVersion = 0;
+	inline static u32 s_UpdatedCount = 0;
+	inline static f32 s_UpdateMilliseconds = 0.0f;
+};
@@ -0,0 +1,164 @@
+#pragma once
+#include <cstring>
+#include <vector>
+#include "core/Base.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+// Number of distinct component types a registry can hold, must be 64, 128 or 256
+#ifndef ECS_MAX_COMPONENTS
+#define ECS_MAX_COMPONENTS 128
+#endif
+
+// One bit per component id stored as whole words, aligned to its own size so a mask loads as a single
+// vector and a packed array of masks can be scanned several entities at a time.
+template<size_t Bits>
+class alignas(Bits / 8) ComponentMask {
+	static_assert(Bits == 64 || Bits == 128 || Bits == 256, "Component masks must be 64, 128 or 256 bits wide");
+public:
+	static constexpr size_t WordCount = Bits / 64;
+
+	ComponentMask() = default;
+
+	// Mask of the given components, a compile time constant since component ids are. Defined in Registry.h
+	template<typename... Components>
+	static constexpr ComponentMask Of();
+
+	bool operator==(const ComponentMask& otherMask) const {
+		for (size_t i = 0; i < WordCount; i++) {
+			if (m_Words[i] != otherMask.m_Words[i]) return false;
+		}
+		return true;
+	}
+
+	bool Empty() const {
+		u64 bits = 0;
+		for (size_t i = 0; i < WordCount; i++) bits |= m_Words[i];
+		return bits == 0;
+	}
+
+	bool IsSubsetOf(const ComponentMask& superSet) const {
+		u64 missing = 0;
+		for (size_t i = 0; i < WordCount; i++) missing |= m_Words[i] & ~superSet.m_Words[i];
+		return missing == 0;
+	}
+
+	bool SharesAnyWith(const ComponentMask& otherMask) const {
+		u64 shared = 0;
+		for (size_t i = 0; i < WordCount; i++) shared |= m_Words[i] & otherMask.m_Words[i];
+		return shared != 0;
+	}
+
+	constexpr void Set(const u32 index) { m_Words[index / 64] |= 1ull << (index % 64); }
+	void Reset(const u32 index) { m_Words[index / 64] &= ~(1ull << (index % 64)); }
+	bool Test(const u32 index) const { return (m_Words[index / 64] >> (index % 64)) & 1; }
+
+	struct Hash {
+		size_t operator()(const ComponentMask& mask) const {
+			u64 hash = 0;
+			for (size_t i = 0; i < WordCount; i++) {
+				hash = (hash ^ mask.m_Words[i]) * 1099511628211ull;
+			}
+			return static_cast<size_t>(hash);
+		}
+	};
+public:
+	u64 m_Words[WordCount] = {};
+};
+
+#if defined(__AVX2__)
+using MaskVector = __m256i;
+inline MaskVector MaskLoad(const void* address) { return _mm256_loadu_si256(static_cast<const __m256i*>(address)); }
+inline MaskVector MaskAnd(MaskVector a, MaskVector b) { return _mm256_and_si256(a, b); }
+inline MaskVector MaskEqual(MaskVector a, MaskVector b) { return _mm256_cmpeq_epi8(a, b); }
+inline MaskVector MaskZero() { return _mm256_setzero_si256(); }
+inline u64 MaskBytes(MaskVector a) { return static_cast<u32>(_mm256_movemask_epi8(a)); }
+#define ECS_MASK_VECTOR_BYTES 32
+#elif defined(__SSE2__) || defined(_M_X64)
+using MaskVector = __m128i;
+inline MaskVector MaskLoad(const void* address) { return _mm_loadu_si128(static_cast<const __m128i*>(address)); }
+inline MaskVector MaskAnd(MaskVector a, MaskVector b) { return _mm_and_si128(a, b); }
+inline MaskVector MaskEqual(MaskVector a, MaskVector b) { return _mm_cmpeq_epi8(a, b); }
+inline MaskVector MaskZero() { return _mm_setzero_si128(); }
+inline u64 MaskBytes(MaskVector a) { return static_cast<u32>(_mm_movemask_epi8(a)); }
+#define ECS_MASK_VECTOR_BYTES 16
+#endif
+
+// Appends the index of every mask in the array that contains all of required and none of excluded
+template<size_t Bits>
+void FindMatchingMasks(const ComponentMask<Bits>* masks, const size_t count, const ComponentMask<Bits>& required,
+                       const ComponentMask<Bits>& excluded, std::vector<u32>& matches) {
+	size_t i = 0;
+
+#ifdef ECS_MASK_VECTOR_BYTES
+	constexpr size_t vectorBytes = ECS_MASK_VECTOR_BYTES;
+	constexpr size_t maskBytes = Bits / 8;
+
+	if constexpr (maskBytes <= vectorBytes) {
+		// Several masks per vector, required and excluded are repeated to fill every lane
+		constexpr size_t lanes = vectorBytes / maskBytes;
+		constexpr u64 laneBits = (1ull << maskBytes) - 1;
+
+		alignas(vectorBytes) u8 requiredLanes[vectorBytes];
+		alignas(vectorBytes) u8 excludedLanes[vectorBytes];
+		for (size_t lane = 0; lane < lanes; lane++) {
+			std::memcpy(requiredLanes + lane * maskBytes, required.m_Words, maskBytes);
+			std::memcpy(excludedLanes + lane * maskBytes, excluded.m_Words, maskBytes);
+		}
+
+		const MaskVector requiredVector = MaskLoad(requiredLanes);
+		const MaskVector excludedVector = MaskLoad(excludedLanes);
+		const MaskVector zero = MaskZero();
+
+		for (; i + lanes <= count; i += lanes) {
+			const MaskVector entityMasks = MaskLoad(masks + i);
+			const MaskVector hasRequired = MaskEqual(MaskAnd(entityMasks, requiredVector), requiredVector);
+			const MaskVector hasNoExcluded = MaskEqual(MaskAnd(entityMasks, excludedVector), zero);
+			const u64 bytes = MaskBytes(MaskAnd(hasRequired, hasNoExcluded));
+
+			if (bytes == 0) continue;
+			for (size_t lane = 0; lane < lanes; lane++) {
+				if (((bytes >> (lane * maskBytes)) & laneBits) == laneBits) {
+					matches.push_back(static_cast<u32>(i + lane));
+				}
+			}
+		}
+	}
+	else {
+		// A mask spans several vectors, all of them have to pass
+		constexpr size_t vectorsPerMask = maskBytes / vectorBytes;
+		constexpr u64 allBytes = (1ull << vectorBytes) - 1;
+		const MaskVector zero = MaskZero();
+
+		for (; i < count; i++) {
+			const u8* entityBytes = reinterpret_cast<const u8*>(masks + i);
+			const u8* requiredBytes = reinterpret_cast<const u8*>(required.m_Words);
+			const u8* excludedBytes = reinterpret_cast<const u8*>(excluded.m_Words);
+
+			u64 bytes = allBytes;
+			for (size_t v = 0; v < vectorsPerMask; v++) {
+				const MaskVector entityMask = MaskLoad(entityBytes + v * vectorBytes);
+				const MaskVector requiredVector = MaskLoad(requiredBytes + v * vectorBytes);
+				const MaskVector excludedVector = MaskLoad(excludedBytes + v * vectorBytes);
+				const MaskVector hasRequired = MaskEqual(MaskAnd(entityMask, requiredVector), requiredVector);
+				const MaskVector hasNoExcluded = MaskEqual(MaskAnd(entityMask, excludedVector), zero);
+				bytes &= MaskBytes(MaskAnd(hasRequired, hasNoExcluded));
+			}
+
+			if (bytes == allBytes) {
+				matches.push_back(static_cast<u32>(i));
+			}
+		}
+	}
+#endif
+
+	for (; i < count; i++) {
+		if (required.IsSubsetOf(masks[i]) && !excluded.SharesAnyWith(masks[i])) {
+			matches.push_back(static_cast<u32>(i));
+		}
+	}
+}
@@ -1,15 +1,138 @@
+#include <algorithm>
+#include <cstring>
 #include "ComponentPool.h"
 
-ComponentPool::ComponentPool(const u32 compSize) {
+ComponentPool::ComponentPool(const ComponentVTable& vtable) : m_VTable(vtable) {
 	m_NextCompIndex = 0;
-	m_ComponentOffsetsSize = 0;
-	m_CurBufferSize = 1;
-	m_CompSize = compSize;
-	
-	m_Buffer = MakeRef<u8[]>(compSize * m_CurBufferSize);
-	m_ComponentOffsets = MakeRef<u32[]>(m_CurBufferSize);
+}
+
+ComponentPool::~ComponentPool() {
+	for (size_t i = 0; i < m_NextCompIndex; i++) {
+		m_VTable.destroy(GetDenseAddress(i));
+	}
+
+	for (u8* page : m_Pages) {
+		::operator delete(page, std::align_val_t(m_VTable.alignment));
+	}
+}
+
+size_t ComponentPool::Size() const {
+	return m_NextCompIndex;
+}
+
+size_t ComponentPool::DenseIndexOf(const size_t index) const {
+	return SparseAt(index);
+}
+
+void* ComponentPool::GetDenseAddress(const size_t denseIndex) const {
+	u8* page = m_Pages[denseIndex / COMPONENTS_PER_PAGE];
+	return page + (m_VTable.size * (denseIndex % COMPONENTS_PER_PAGE));
+}
+
+size_t ComponentPool::ContiguousFrom(const size_t denseIndex) const {
+	return COMPONENTS_PER_PAGE - (denseIndex % COMPONENTS_PER_PAGE);
+}
+
+const std::vector<u32>& ComponentPool::DenseEntities() const {
+	return m_DenseEntities;
+}
+
+void ComponentPool::Remove(const size_t index) {
+	const size_t denseIndex = SparseAt(index);
+	const size_t lastIndex = m_NextCompIndex - 1;
+
+	void* hole = GetDenseAddress(denseIndex);
+	m_VTable.destroy(hole);
+
+	if (denseIndex != lastIndex) {
+		void* last = GetDenseAddress(lastIndex);
+		m_VTable.moveConstruct(hole, last);
+		m_VTable.destroy(last);
+
+		const u32 lastEntity = m_DenseEntities[lastIndex];
+		m_DenseEntities[denseIndex] = lastEntity;
+		m_Versions[denseIndex] = m_Versions[lastIndex];
+		SparseSlot(lastEntity) = static_cast<u32>(denseIndex);
+	}
+
+	m_DenseEntities.pop_back();
+	m_Versions.pop_back();
+	m_NextCompIndex--;
+}
+
+void ComponentPool::Reserve(const size_t componentCount) {
+	while (m_Pages.size() * COMPONENTS_PER_PAGE < componentCount) {
+		AddPage();
+	}
+	m_DenseEntities.reserve(componentCount);
+	m_Versions.reserve(componentCount);
+}
+
+void ComponentPool::CopyDense(void* destination) const {
+	u8* target = static_cast<u8*>(destination);
+
+	for (size_t denseIndex = 0; denseIndex < m_NextCompIndex; denseIndex += COMPONENTS_PER_PAGE) {
+		const size_t count = std::min(COMPONENTS_PER_PAGE, m_NextCompIndex - denseIndex);
+		std::memcpy(target, GetDenseAddress(denseIndex), count * m_VTable.size);
+		target += count * m_VTable.size;
+	}
+}
+
+void ComponentPool::MoveToDenseIndex(const size_t index, const size_t denseIndex) {
+	const size_t curDenseIndex = SparseAt(index);
+	if (curDenseIndex != denseIndex) {
+		SwapDense(curDenseIndex, denseIndex);
+	}
+}
+
+u32 ComponentPool::VersionOf(const size_t index) const {
+	return m_Versions[SparseAt(index)];
+}
+
+u32 ComponentPool::VersionAtDense(const size_t denseIndex) const {
+	return m_Versions[denseIndex];
+}
+
+void ComponentPool::SetVersion(const size_t index, const u32 version) {
+	m_Versions[SparseAt(index)] = version;
+}
+
+void ComponentPool::SetVersionAtDense(const size_t denseIndex, const u32 version) {
+	m_Versions[denseIndex] = version;
 }
 
 void* ComponentPool::GetComponentAddress(const size_t index) const {
-	return (m_Buffer.get() + (m_CompSize * m_ComponentOffsets[index]));
-}
\ No newline at end of file
+	return GetDenseAddress(SparseAt(index));
+}
+
+void ComponentPool::SwapDense(const size_t first, const size_t second) {
+	m_VTable.swap(GetDenseAddress(first), GetDenseAddress(second));
+
+	std::swap(m_DenseEntities[first], m_DenseEntities[second]);
+	std::swap(m_Versions[first], m_Versions[second]);
+	SparseSlot(m_DenseEntities[first]) = static_cast<u32>(first);
+	SparseSlot(m_DenseEntities[second]) = static_cast<u32>(second);
+}
+
+void ComponentPool::AddPage() {
+	const size_t pageSize = m_VTable.size * COMPONENTS_PER_PAGE;
+	m_Pages.push_back(static_cast<u8*>(::operator new(pageSize, std::align_val_t(m_VTable.alignment))));
+}
+
+u32& ComponentPool::SparseSlot(const size_t index) {
+	const size_t page = index / ENTITIES_PER_SPARSE_PAGE;
+
+	if (page >= m_SparsePages.size()) {
+		m_SparsePages.resize(page + 1);
+	}
+
+	if (!m_SparsePages[page]) {
+		m_SparsePages[page] = MakeScope<u32[]>(ENTITIES_PER_SPARSE_PAGE);
+	}
+
+	return m_SparsePages[page][index % ENTITIES_PER_SPARSE_PAGE];
+}
+
+u32 ComponentPool::SparseAt(const size_t index) const {
+	return m_SparsePages[index / ENTITIES_PER_SPARSE_PAGE][index % ENTITIES_PER_SPARSE_PAGE];
+}
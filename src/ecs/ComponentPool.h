@@ -1,29 +1,112 @@
 #pragma once
-#include <cmath>
+#include <new>
+#include <vector>
+#include <utility>
 #include "core/Base.h"
 
+// Components are stored in fixed size pages that are never reallocated, so growing a pool never moves
+// existing components. References returned by Get are still invalidated by removing any component of
+// the pool, since the last component is moved into the freed slot, and in StorageMode::Archetype by the
+// repack that the first view or group iteration after a structural change runs.
+constexpr size_t COMPONENTS_PER_PAGE = 256;
+
+// The entity index to dense index lookup is paged as well and pages are only allocated once an entity
+// in their range gets the component, so a pool with few members stays small even for large entity ids.
+constexpr size_t ENTITIES_PER_SPARSE_PAGE = 4096;
+
+// Type erased operations a pool needs to manage components it only knows the size of
+struct ComponentVTable {
+	u32 size;
+	u32 alignment;
+	void (*moveConstruct)(void* destination, void* source);
+	void (*destroy)(void* component);
+	void (*swap)(void* first, void* second);
+
+	template<typename Component>
+	static const ComponentVTable& Of();
+};
+
 class ComponentPool {
 public:
-	ComponentPool(const u32 compSize);
+	explicit ComponentPool(const ComponentVTable& vtable);
+	~ComponentPool();
+
+	ComponentPool(const ComponentPool&) = delete;
+	ComponentPool& operator=(const ComponentPool&) = delete;
 
 	template<typename Component>
 	Component& Get(const size_t index);
 
 	template<typename Component>
 	Component& Add(const size_t index);
+
+	// Destroys the entity's component and moves the last component into the hole
+	void Remove(const size_t index);
+
+	// Allocates enough pages up front to hold componentCount components
+	void Reserve(const size_t componentCount);
+
+	size_t Size() const;
+	size_t DenseIndexOf(const size_t index) const;
+	void* GetDenseAddress(const size_t denseIndex) const;
+
+	// Number of dense slots starting at denseIndex that are contiguous in memory before the page ends
+	size_t ContiguousFrom(const size_t denseIndex) const;
+
+	// Entity indices in the same order as their components, every entry is a live component
+	const std::vector<u32>& DenseEntities() const;
+
+	// Copies every component in dense order with one memcpy per page, only valid for trivially copyable components
+	void CopyDense(void* destination) const;
+
+	// Moves an entity's component into the given dense slot, swapping out whatever was there
+	void MoveToDenseIndex(const size_t index, const size_t denseIndex);
+
+	// Registry version at which the entity's component was last accessed mutably
+	u32 VersionOf(const size_t index) const;
+	u32 VersionAtDense(const size_t denseIndex) const;
+	void SetVersion(const size_t index, const u32 version);
+	void SetVersionAtDense(const size_t denseIndex, const u32 version);
 private:
 	void* GetComponentAddress(const size_t index) const;
+	void SwapDense(const size_t first, const size_t second);
+	void AddPage();
+	u32& SparseSlot(const size_t index);
+	u32 SparseAt(const size_t index) const;
 private:
-	u32 m_CompSize;
+	const ComponentVTable& m_VTable;
 	u32 m_NextCompIndex;
-	
-	size_t m_CurBufferSize;
-	Ref<u8[]> m_Buffer;
 
-	size_t m_ComponentOffsetsSize;
-	Ref<u32[]> m_ComponentOffsets;
+	std::vector<u8*> m_Pages;
+
+	// Dense index of each entity's component, pages are null until used
+	std::vector<Scope<u32[]>> m_SparsePages;
+
+	// Entity index that owns each dense slot
+	std::vector<u32> m_DenseEntities;
+
+	// Change version of each dense slot, moved together with the component
+	std::vector<u32> m_Versions;
 };
 
+template<typename Component>
+const ComponentVTable& ComponentVTable::Of() {
+	static const ComponentVTable vtable {
+		.size = sizeof(Component),
+		.alignment = alignof(Component),
+		.moveConstruct = [](void* destination, void* source) {
+			new (destination) Component(std::move(*static_cast<Component*>(source)));
+		},
+		.destroy = [](void* component) {
+			static_cast<Component*>(component)->~Component();
+		},
+		.swap = [](void* first, void* second) {
+			std::swap(*static_cast<Component*>(first), *static_cast<Component*>(second));
+		},
+	};
+	return vtable;
+}
+
 template <typename Component>
 Component& ComponentPool::Get(const size_t index) {
 	return *static_cast<Component*>(GetComponentAddress(index));
@@ -31,29 +114,15 @@ Component& ComponentPool::Get(const size_t index) {
 
 template <typename Component>
 Component& ComponentPool::Add(const size_t index) {
-	if (index >= m_ComponentOffsetsSize) {
-		const size_t oldSize = m_ComponentOffsetsSize;
-		m_ComponentOffsetsSize = index + 1;
-		
-		const Ref<u32[]> tempComponentOffsets = m_ComponentOffsets;
-		m_ComponentOffsets = MakeRef<u32[]>(m_ComponentOffsetsSize);
-		memcpy(m_ComponentOffsets.get(), tempComponentOffsets.get(), sizeof(u32) * oldSize);
+	if (m_NextCompIndex >= m_Pages.size() * COMPONENTS_PER_PAGE) {
+		AddPage();
 	}
 
-	if (m_NextCompIndex >= m_CurBufferSize) {
-		const size_t oldSize = m_CurBufferSize;
-		
-		constexpr f32 resizeScaler = 1.5;
-		m_CurBufferSize = static_cast<size_t>(std::ceil(m_CurBufferSize * resizeScaler));
-
-		const Ref<u8[]> tempBuffer = m_Buffer;
-		m_Buffer = MakeRef<u8[]>(m_CompSize * m_CurBufferSize);
-		memcpy(m_Buffer.get(), tempBuffer.get(), m_CompSize * oldSize);
-	}
-	
-	m_ComponentOffsets[index] = m_NextCompIndex;
+	SparseSlot(index) = m_NextCompIndex;
+	m_DenseEntities.push_back(static_cast<u32>(index));
+	m_Versions.push_back(0);
 	m_NextCompIndex++;
-	
+
 	Component* component = new (GetComponentAddress(index))Component;
 	return *component;
 }
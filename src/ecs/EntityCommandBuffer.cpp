@@ -0,0 +1,109 @@
+#include "EntityCommandBuffer.h"
+
+EntityCommandBuffer::~EntityCommandBuffer() {
+	Clear();
+
+	for (u8* block : m_Blocks) {
+		::operator delete(block, std::align_val_t(BLOCK_ALIGNMENT));
+	}
+}
+
+Entity EntityCommandBuffer::Create() {
+	std::lock_guard lock(m_Mutex);
+	return Entity(m_PendingCount++, PENDING_GENERATION);
+}
+
+void EntityCommandBuffer::Destroy(const Entity entity) {
+	std::lock_guard lock(m_Mutex);
+	m_Commands.push_back({ CommandType::Destroy, entity, nullptr, nullptr, nullptr });
+}
+
+void EntityCommandBuffer::Playback(Registry& registry) {
+	std::lock_guard lock(m_Mutex);
+
+	// All placeholders are turned into entities up front so creation is a single batch
+	m_Created = registry.CreateMany(m_PendingCount);
+
+	for (Command& command : m_Commands) {
+		const Entity entity = Resolve(command.entity);
+
+		if (registry.IsValid(entity)) {
+			switch (command.type)
+			{
+			case CommandType::Destroy:
+				registry.Destroy(entity);
+				break;
+
+			case CommandType::Add:
+			case CommandType::Remove:
+				command.apply(registry, entity, command.payload);
+				break;
+			}
+		}
+
+		if (command.payload) {
+			command.vtable->destroy(command.payload);
+			command.payload = nullptr;
+		}
+	}
+
+	m_Created.clear();
+	Reset();
+}
+
+void EntityCommandBuffer::Clear() {
+	std::lock_guard lock(m_Mutex);
+	Reset();
+}
+
+bool EntityCommandBuffer::Empty() const {
+	std::lock_guard lock(m_Mutex);
+	return m_Commands.empty() && m_PendingCount == 0;
+}
+
+void* EntityCommandBuffer::Allocate(const size_t size, const size_t alignment) {
+	if (size > BLOCK_SIZE || alignment > BLOCK_ALIGNMENT) {
+		void* payload = ::operator new(size, std::align_val_t(alignment));
+		m_LargePayloads.emplace_back(payload, alignment);
+		return payload;
+	}
+
+	size_t offset = (m_BlockOffset + alignment - 1) & ~(alignment - 1);
+	if (m_BlockIndex >= m_Blocks.size() || offset + size > BLOCK_SIZE) {
+		if (m_BlockIndex < m_Blocks.size()) {
+			m_BlockIndex++;
+		}
+		if (m_BlockIndex >= m_Blocks.size()) {
+			m_Blocks.push_back(static_cast<u8*>(::operator new(BLOCK_SIZE, std::align_val_t(BLOCK_ALIGNMENT))));
+		}
+		offset = 0;
+	}
+
+	m_BlockOffset = offset + size;
+	return m_Blocks[m_BlockIndex] + offset;
+}
+
+Entity EntityCommandBuffer::Resolve(const Entity entity) const {
+	if (entity.Generation() == PENDING_GENERATION) {
+		return m_Created[entity.Id()];
+	}
+	return entity;
+}
+
+void EntityCommandBuffer::Reset() {
+	for (const Command& command : m_Commands) {
+		if (command.payload) {
+			command.vtable->destroy(command.payload);
+		}
+	}
+
+	for (auto [payload, alignment] : m_LargePayloads) {
+		::operator delete(payload, std::align_val_t(alignment));
+	}
+
+	m_LargePayloads.clear();
+	m_Commands.clear();
+	m_PendingCount = 0;
+	m_BlockIndex = 0;
+	m_BlockOffset = 0;
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include <mutex>
+#include <vector>
+#include "Registry.h"
+
+// Records structural changes so they can be made while views are being iterated, or from worker threads,
+// and applies them later in one pass at a point where nothing else touches the registry.
+// Recording is thread safe, Playback is not and must run on the thread that owns the registry.
+class EntityCommandBuffer {
+public:
+	EntityCommandBuffer() = default;
+	~EntityCommandBuffer();
+
+	EntityCommandBuffer(const EntityCommandBuffer&) = delete;
+	EntityCommandBuffer& operator=(const EntityCommandBuffer&) = delete;
+
+	// Returns a placeholder that can be passed to later commands of this buffer. It only becomes
+	// a real entity during playback and must not be used with the registry directly.
+	Entity Create();
+	void Destroy(Entity entity);
+
+	// Overwrites the component if the entity already has it by the time the buffer is played back
+	template<typename Component>
+	void Add(Entity entity, Component component = {});
+
+	template<typename Component>
+	void Remove(Entity entity);
+
+	// Applies the commands in the order they were recorded and clears the buffer. Commands targeting
+	// entities that were destroyed in the meantime are skipped.
+	void Playback(Registry& registry);
+	void Clear();
+	bool Empty() const;
+private:
+	enum class CommandType { Destroy, Add, Remove };
+
+	struct Command {
+		CommandType type;
+		Entity entity;
+
+		// Typed registry call for Add and Remove, payload holds the component to add
+		void (*apply)(Registry& registry, Entity entity, void* payload);
+		void* payload;
+		const ComponentVTable* vtable;
+	};
+
+	void* Allocate(size_t size, size_t alignment);
+	Entity Resolve(const Entity entity) const;
+	void Reset();
+private:
+	// Payloads are bump allocated from blocks that are kept between frames
+	static constexpr size_t BLOCK_SIZE = 16 * 1024;
+	static constexpr size_t BLOCK_ALIGNMENT = 64;
+
+	// Placeholders use this generation, which a live entity realistically never reaches
+	static constexpr u32 PENDING_GENERATION = ~0u;
+
+	mutable std::mutex m_Mutex;
+	std::vector<Command> m_Commands;
+	u32 m_PendingCount = 0;
+
+	std::vector<u8*> m_Blocks;
+	size_t m_BlockIndex = 0;
+	size_t m_BlockOffset = 0;
+
+	// Oversized payloads get their own allocation
+	std::vector<std::pair<void*, size_t>> m_LargePayloads;
+
+	std::vector<Entity> m_Created;
+};
+
+template<typename Component>
+void EntityCommandBuffer::Add(const Entity entity, Component component) {
+	std::lock_guard lock(m_Mutex);
+
+	void* payload = Allocate(sizeof(Component), alignof(Component));
+	new (payload) Component(std::move(component));
+
+	const auto apply = [](Registry& registry, const Entity target, void* source) {
+		registry.GetAdd<Component>(target) = std::move(*static_cast<Component*>(source));
+	};
+	m_Commands.push_back({ CommandType::Add, entity, apply, payload, &ComponentVTable::Of<Component>() });
+}
+
+template<typename Component>
+void EntityCommandBuffer::Remove(const Entity entity) {
+	std::lock_guard lock(m_Mutex);
+
+	const auto apply = [](Registry& registry, const Entity target, void*) {
+		if (registry.Has<Component>(target)) {
+			registry.Remove<Component>(target);
+		}
+	};
+	m_Commands.push_back({ CommandType::Remove, entity, apply, nullptr, nullptr });
+}
@@ -0,0 +1,55 @@
+#include "Group.h"
+
+Group::Group(Registry& registry, const EntityCompMask& mask, const EntityCompMask& excludeMask)
+	: m_Registry(registry), m_Mask(mask), m_ExcludeMask(excludeMask) { }
+
+std::vector<Entity>::iterator Group::begin() {
+	// Archetype registries rebuild groups in archetype order when they repack so the walk stays linear
+	m_Registry.RefreshArchetypes();
+	return m_Entities.begin();
+}
+
+std::vector<Entity>::iterator Group::end() {
+	return m_Entities.end();
+}
+
+size_t Group::Size() const {
+	return m_Entities.size();
+}
+
+bool Group::Matches(const EntityCompMask& entityMask) const {
+	return m_Mask.IsSubsetOf(entityMask) && !m_ExcludeMask.SharesAnyWith(entityMask);
+}
+
+bool Group::HasMasks(const EntityCompMask& mask, const EntityCompMask& excludeMask) const {
+	return m_Mask == mask && m_ExcludeMask == excludeMask;
+}
+
+void Group::OnMaskChanged(const Entity entity, const EntityCompMask& entityMask) {
+	const u32 index = entity.Id();
+	if (index >= m_Positions.size()) {
+		m_Positions.resize(index + 1, NotInGroup);
+	}
+
+	const bool inGroup = m_Positions[index] != NotInGroup;
+	const bool matches = Matches(entityMask);
+
+	if (matches && !inGroup) {
+		m_Positions[index] = static_cast<u32>(m_Entities.size());
+		m_Entities.push_back(entity);
+	}
+	else if (!matches && inGroup) {
+		const u32 position = m_Positions[index];
+		const Entity last = m_Entities.back();
+
+		m_Entities[position] = last;
+		m_Positions[last.Id()] = position;
+		m_Entities.pop_back();
+		m_Positions[index] = NotInGroup;
+	}
+}
+
+void Group::Clear() {
+	m_Entities.clear();
+	m_Positions.clear();
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <utility>
+#include "Registry.h"
+
+// Persistent query owned by the registry. The matching entities are kept in a plain array that is
+// updated whenever a component is added or removed, so iterating it never tests any masks.
+class Group {
+public:
+	Group(Registry& registry, const EntityCompMask& mask, const EntityCompMask& excludeMask);
+
+	std::vector<Entity>::iterator begin();
+	std::vector<Entity>::iterator end();
+
+	// Calls func(Entity, Components&...) for every entity in the group with the pools resolved up front.
+	// Components must be part of the group's query.
+	template<typename... Components, typename Func>
+	void Each(Func&& func);
+
+	size_t Size() const;
+	bool Matches(const EntityCompMask& entityMask) const;
+	bool HasMasks(const EntityCompMask& mask, const EntityCompMask& excludeMask) const;
+private:
+	template<typename... Components, typename Func, size_t... Indices>
+	void Each(Func& func, std::index_sequence<Indices...>);
+
+	void OnMaskChanged(const Entity entity, const EntityCompMask& entityMask);
+	void Clear();
+private:
+	static constexpr u32 NotInGroup = static_cast<u32>(-1);
+
+	Registry& m_Registry;
+	EntityCompMask m_Mask;
+	EntityCompMask m_ExcludeMask;
+
+	std::vector<Entity> m_Entities;
+
+	// Position of each entity index inside m_Entities or NotInGroup
+	std::vector<u32> m_Positions;
+
+	friend class Registry;
+};
+
+template<typename... Components, typename Func>
+void Group::Each(Func&& func) {
+	Each<Components...>(func, std::index_sequence_for<Components...>());
+}
+
+template<typename... Components, typename Func, size_t... Indices>
+void Group::Each(Func& func, std::index_sequence<Indices...>) {
+	ComponentPool* pools[] = { m_Registry.GetPool<Components>()... };
+	m_Registry.RefreshArchetypes();
+	const IterationScope scope(m_Registry);
+	for (const Entity entity : m_Entities) {
+		func(entity, pools[Indices]->template Get<Components>(entity.Id())...);
+	}
+}
+
+template<typename... Components, typename... Excluded>
+Group& Registry::GetGroup(Exclude<Excluded...>) {
+	constexpr EntityCompMask mask = EntityCompMask::Of<Components...>();
+	constexpr EntityCompMask excludeMask = EntityCompMask::Of<Excluded...>();
+
+	for (const Scope<Group>& group : m_Groups) {
+		if (group->HasMasks(mask, excludeMask)) {
+			return *group;
+		}
+	}
+
+	Group& group = *m_Groups.emplace_back(MakeScope<Group>(*this, mask, excludeMask));
+
+	std::vector<u32> matches;
+	FindMatchingMasks(m_EntityCompMasks.data(), m_EntityCompMasks.size(), mask, excludeMask, matches);
+	for (const u32 index : matches) {
+		group.OnMaskChanged(m_Entities[index], m_EntityCompMasks[index]);
+	}
+	return group;
+}
@@ -1,56 +1,235 @@
+#include "Group.h"
 #include "Registry.h"
 
+Registry::Registry() = default;
+
+Registry::Registry(const StorageMode storageMode) : m_StorageMode(storageMode) { }
+
+Registry::~Registry() = default;
+
 Entity Registry::Create() {
-    const Entity newEntity(m_Entities.size());
+    if (!m_FreeIndices.empty()) {
+        const u32 index = m_FreeIndices.back();
+        m_FreeIndices.pop_back();
+        return m_Entities[index];
+    }
+
+    const Entity newEntity(static_cast<u32>(m_Entities.size()));
     m_Entities.push_back(newEntity);
     m_EntityCompMasks.emplace_back();
     return newEntity;
 }
 
+std::vector<Entity> Registry::CreateMany(const size_t count) {
+	std::vector<Entity> entities;
+	entities.reserve(count);
+
+	while (entities.size() < count && !m_FreeIndices.empty()) {
+		entities.push_back(m_Entities[m_FreeIndices.back()]);
+		m_FreeIndices.pop_back();
+	}
+
+	const size_t firstNewIndex = m_Entities.size();
+	const size_t newCount = count - entities.size();
+
+	m_Entities.reserve(firstNewIndex + newCount);
+	for (size_t i = 0; i < newCount; i++) {
+		const Entity newEntity(static_cast<u32>(firstNewIndex + i));
+		m_Entities.push_back(newEntity);
+		entities.push_back(newEntity);
+	}
+	m_EntityCompMasks.resize(m_Entities.size());
+
+	return entities;
+}
+
+void Registry::Destroy(const Entity entity) {
+	ASSERT(IsValid(entity), "Destroying stale entity " << entity.Id());
+
+	const u32 index = entity.Id();
+	EntityCompMask& mask = m_EntityCompMasks[index];
+
+	for (u32 compId = 0; compId < m_Pools.size(); compId++) {
+		if (mask.Test(compId)) {
+			m_Pools[compId]->Remove(index);
+		}
+	}
+
+	if (!mask.Empty()) {
+		m_ArchetypesDirty = true;
+	}
+
+	mask = EntityCompMask();
+	OnMaskChanged(entity);
+
+	m_Entities[index] = Entity(index, entity.Generation() + 1);
+	m_FreeIndices.push_back(index);
+}
+
+void Registry::ReserveEntities(const size_t entityCount) {
+	m_Entities.reserve(entityCount);
+	m_EntityCompMasks.reserve(entityCount);
+}
+
+bool Registry::IsValid(const Entity entity) const {
+	return entity.Id() < m_Entities.size() && m_Entities[entity.Id()] == entity;
+}
+
 void Registry::FreeAll() {
 	m_Entities.clear();
+	m_FreeIndices.clear();
 	m_Pools.clear();
 	m_EntityCompMasks.clear();
+	m_Archetypes.clear();
+	m_ArchetypesDirty = false;
+	m_StructureVersion = m_Version;
+	m_StructureChangeCount++;
+
+	for (const Scope<Group>& group : m_Groups) {
+		group->Clear();
+	}
 }
 
 size_t Registry::GetEntityCount() {
     return m_Entities.size();
 }
 
-Entity::Entity(const size_t id) : m_Id(id) { }
+StorageMode Registry::GetStorageMode() const {
+	return m_StorageMode;
+}
 
-size_t Entity::Id() const {
-    return m_Id;
+u32 Registry::GetVersion() const {
+	return m_Version;
 }
 
-bool Entity::operator==(const Entity& other) const {
-    return m_Id == other.Id();
+u32 Registry::AdvanceVersion() {
+	return m_Version++;
 }
 
-Entity Entity::Null() {
-    return static_cast<size_t>(-1);
+u32 Registry::GetStructureVersion() const {
+	return m_StructureVersion;
 }
 
-bool EntityCompMask::operator==(const EntityCompMask& otherMask) const {
-	return m_Mask == otherMask.m_Mask;
+u32 Registry::GetStructureChangeCount() const {
+	return m_StructureChangeCount;
 }
 
-bool EntityCompMask::Empty() const {
-	return m_Mask.none();
+u32 Registry::GetId() const {
+	return m_Id;
 }
 
-bool EntityCompMask::IsSubsetOf(const EntityCompMask& superSet) const {
-	return (m_Mask & superSet.m_Mask) == m_Mask;
+void Registry::RefreshArchetypes() {
+	if (m_StorageMode == StorageMode::Archetype && m_ArchetypesDirty) {
+		PackArchetypes();
+	}
 }
 
-bool EntityCompMask::SharesAnyWith(const EntityCompMask& otherMask) const {
-	return (m_Mask & otherMask.m_Mask).any();
+void Registry::PackArchetypes() {
+	ASSERT(m_ActiveIterations == 0, "Archetypes repacked while " << m_ActiveIterations.load()
+	       << " iterations are in progress, defer structural changes with an EntityCommandBuffer");
+	m_Archetypes.clear();
+
+	std::unordered_map<EntityCompMask, size_t, EntityCompMask::Hash> archetypeLookUp;
+
+	for (size_t i = 0; i < m_Entities.size(); i++) {
+		const EntityCompMask& mask = m_EntityCompMasks[i];
+		if (mask.Empty()) continue;
+
+		auto [lookUp, inserted] = archetypeLookUp.try_emplace(mask, m_Archetypes.size());
+		if (inserted) {
+			Archetype& archetype = m_Archetypes.emplace_back();
+			archetype.mask = mask;
+			archetype.poolOffsets.resize(m_Pools.size());
+		}
+
+		m_Archetypes[lookUp->second].entities.push_back(m_Entities[i]);
+	}
+
+	// Lay each pool out archetype by archetype. Since every archetype lists its entities in the same order,
+	// row N of an archetype lives at poolOffsets[compId] + N in every pool it spans.
+	for (u32 compId = 0; compId < m_Pools.size(); compId++) {
+		if (!m_Pools[compId]) continue;
+
+		ComponentPool& pool = *m_Pools[compId];
+		size_t denseIndex = 0;
+
+		for (Archetype& archetype : m_Archetypes) {
+			if (!archetype.mask.Test(compId)) continue;
+
+			archetype.poolOffsets[compId] = static_cast<u32>(denseIndex);
+			for (const Entity entity : archetype.entities) {
+				pool.MoveToDenseIndex(entity.Id(), denseIndex);
+				denseIndex++;
+			}
+		}
+	}
+
+	// Refill groups archetype by archetype so they visit pools in the same order they are laid out
+	for (const Scope<Group>& group : m_Groups) {
+		group->Clear();
+		for (const Archetype& archetype : m_Archetypes) {
+			if (!group->Matches(archetype.mask)) continue;
+
+			for (const Entity entity : archetype.entities) {
+				group->OnMaskChanged(entity, archetype.mask);
+			}
+		}
+	}
+
+	m_ArchetypesDirty = false;
+}
+
+void Registry::OnMaskChanged(const Entity entity) {
+	m_StructureVersion = m_Version;
+	m_StructureChangeCount++;
+
+	const EntityCompMask& mask = m_EntityCompMasks[entity.Id()];
+	for (const Scope<Group>& group : m_Groups) {
+		group->OnMaskChanged(entity, mask);
+	}
 }
 
-void EntityCompMask::Set(const u32 index) {
-	m_Mask.set(index);
+IterationScope::IterationScope(Registry& registry) : m_Registry(&registry) {
+#ifndef NDEBUG
+	m_Registry->m_ActiveIterations++;
+#endif
 }
 
-bool EntityCompMask::Test(const u32 index) const {
-	return m_Mask.test(index);
-}
\ No newline at end of file
+IterationScope::IterationScope(const IterationScope& other) : m_Registry(other.m_Registry) {
+#ifndef NDEBUG
+	if (m_Registry) m_Registry->m_ActiveIterations++;
+#endif
+}
+
+IterationScope& IterationScope::operator=(const IterationScope& other) {
+#ifndef NDEBUG
+	if (other.m_Registry) other.m_Registry->m_ActiveIterations++;
+	if (m_Registry) m_Registry->m_ActiveIterations--;
+#endif
+	m_Registry = other.m_Registry;
+	return *this;
+}
+
+IterationScope::~IterationScope() {
+#ifndef NDEBUG
+	if (m_Registry) m_Registry->m_ActiveIterations--;
+#endif
+}
+
+Entity::Entity(const u32 index, const u32 generation) : m_Index(index), m_Generation(generation) { }
+
+u32 Entity::Id() const {
+    return m_Index;
+}
+
+u32 Entity::Generation() const {
+    return m_Generation;
+}
+
+bool Entity::operator==(const Entity& other) const {
+    return m_Index == other.m_Index && m_Generation == other.m_Generation;
+}
+
+Entity Entity::Null() {
+    return Entity();
+}
@@ -1,98 +1,271 @@
 #pragma once
+#include <atomic>
 #include <vector>
-#include <bitset>
+#include <type_traits>
+#include <unordered_map>
 #include <filesystem>
 #include <iostream>
 
 #include "core/Base.h"
 #include "ComponentPool.h"
+#include "ComponentMask.h"
 
-constexpr auto MAX_COMPONENTS = 100;
+constexpr size_t MAX_COMPONENTS = ECS_MAX_COMPONENTS;
+using EntityCompMask = ComponentMask<MAX_COMPONENTS>;
+
+constexpr u32 UNLISTED_COMPONENT = static_cast<u32>(-1);
+
+// Bit of each component type in entity masks. The application defines it once for all its components,
+// usually through a ComponentList (see core/Components.h), so ids are compile time constants that don't
+// depend on which type happens to be used first.
+template<typename Component>
+struct ComponentIndex;
+
+// Ordered list of component types, a type's id is its position in the list
+template<typename... Components>
+struct ComponentList {
+	template<typename Component>
+	static constexpr u32 IndexOf() {
+		constexpr bool matches[] = { false, std::is_same_v<Component, Components>... };
+		for (u32 i = 0; i < sizeof...(Components); i++) {
+			if (matches[i + 1]) return i;
+		}
+		return UNLISTED_COMPONENT;
+	}
+};
 
 class Entity;
-class EntityCompMask;
+class Group;
+struct Archetype;
+
+// Tag used to list the components a group must not have, e.g. registry.GetGroup<Transform>(Exclude<Parent>())
+template<typename... Excluded>
+struct Exclude { };
+
+// Sparse keeps components in insertion order which is cheap when entities are created and destroyed often.
+// Archetype keeps every pool sorted so entities sharing a component mask are packed into the same
+// contiguous range of each of their pools, making view iteration a linear walk over memory. The first
+// iteration after any structural change repacks every pool in full, which costs O(entities x pools), so
+// Archetype only pays off for registries whose structure rarely changes.
+enum class StorageMode { Sparse, Archetype };
 
 class Registry {
 public:
+	Registry();
+	explicit Registry(StorageMode storageMode);
+	~Registry();
+
 	Entity Create();
+	void Destroy(Entity entity);
+
+	// Creates count entities at once, reusing destroyed indices first
+	std::vector<Entity> CreateMany(size_t count);
+
+	// Reserves room for entityCount entities in total, plus that many components in each listed pool
+	template<typename... Components>
+	void Reserve(size_t entityCount);
 	void FreeAll();
 
+	// False once the entity has been destroyed, even if its index has since been recycled
+	bool IsValid(const Entity entity) const;
+
 	template<typename Component>
 	Component& Add(Entity entity);
 
+	template<typename Component>
+	void Remove(Entity entity);
+
+	// Mutable access, stamps the component with the current version so View::Changed picks it up
 	template<typename Component>
 	Component& Get(Entity entity);
 
+	// Read only access that leaves the component's version untouched
+	template<typename Component>
+	const Component& Read(Entity entity);
+
+	// Stamps a component that was written through a view or a reference held from earlier
+	template<typename Component>
+	void MarkChanged(Entity entity);
+
 	template<typename Component>
 	bool Has(const Entity entity);
+
+	// Snapshots the whole pool into destination, in the order given by DenseIndexOf. Any structural
+	// change or archetype repack in between invalidates the dense indices.
+	template<typename Component>
+	void CopyComponents(std::vector<Component>& destination);
+
+	template<typename Component>
+	u32 DenseIndexOf(Entity entity);
 	
 	template<typename Component>
 	Component& GetAdd(Entity entity);
 
+	// Bit of the component in entity masks, see ComponentIndex
 	template<typename Component>
-	u32 GetComponentId();
+	static constexpr u32 GetComponentId();
+
+	// Returns the registry's cached group for the query, creating it on first use. Creating isn't thread safe,
+	// so the first call for a query must happen on the main thread. Defined in Group.h
+	template<typename... Components, typename... Excluded>
+	Group& GetGroup(Exclude<Excluded...> = {});
 
 	size_t GetEntityCount();
+	StorageMode GetStorageMode() const;
+
+	// Version that writes are currently stamped with
+	u32 GetVersion() const;
+
+	// Returns the current version and advances it, so every write after this call is newer than the
+	// returned value. A system keeps the result and passes it to View::Changed on its next update.
+	u32 AdvanceVersion();
+
+	// Version of the last time any entity gained or lost a component or was destroyed
+	u32 GetStructureVersion() const;
+
+	// Bumped by every structural change, unlike GetStructureVersion two changes stamped with the same
+	// version still count separately. For caches holding dense indices across frames.
+	u32 GetStructureChangeCount() const;
+
+	// Never reused, unlike the registry's address, so systems can tell which registry their cached state belongs to
+	u32 GetId() const;
 private:
-	inline static u32 m_ComponentCounter = 0;
-	
+	template<typename Component>
+	ComponentPool* GetPool();
+
+	template<typename Component>
+	ComponentPool& GetOrCreatePool();
+
+	void ReserveEntities(size_t entityCount);
+
+	void RefreshArchetypes();
+	void PackArchetypes();
+	void OnMaskChanged(const Entity entity);
+private:
+	inline static u32 m_RegistryCounter = 0;
+
+	const u32 m_Id = m_RegistryCounter++;
+
+	StorageMode m_StorageMode = StorageMode::Sparse;
+	bool m_ArchetypesDirty = false;
+
+	// Starts above zero so a system passing 0 as its first version sees every component as changed
+	u32 m_Version = 1;
+	u32 m_StructureVersion = 1;
+	u32 m_StructureChangeCount = 0;
+
+	// Holds the current generation of every index, including destroyed ones waiting in the free list
 	std::vector<Entity> m_Entities;
-	std::vector<ComponentPool> m_Pools;
+	std::vector<u32> m_FreeIndices;
+	std::vector<Scope<ComponentPool>> m_Pools;
 	std::vector<EntityCompMask> m_EntityCompMasks;
+	std::vector<Archetype> m_Archetypes;
+	std::vector<Scope<Group>> m_Groups;
+
+#ifndef NDEBUG
+	// View iterators and Each calls currently walking the registry. A repack under them would move the
+	// rows they point at, so PackArchetypes asserts this is zero. Atomic since worker systems iterate
+	// at the same time.
+	std::atomic<u32> m_ActiveIterations = 0;
+#endif
 
 	template<typename... T>
 	friend class View;
 	friend class ViewIterator;
+	friend class Group;
 	friend class Editor;
 	friend class Serializer;
 	friend class Selection;
+	friend class TransformSystem;
+	friend class SystemScheduler;
+	friend class IterationScope;
+};
+
+// Marks an iteration over the registry's storage as in progress for as long as it lives. Only counts
+// in debug builds, copies count again so each copied iterator holds its own.
+class IterationScope {
+public:
+	IterationScope() = default;
+	explicit IterationScope(Registry& registry);
+	IterationScope(const IterationScope& other);
+	IterationScope& operator=(const IterationScope& other);
+	~IterationScope();
+private:
+	Registry* m_Registry = nullptr;
 };
 
+// Handle made of a slot index and the generation of that slot. The generation is bumped every time
+// the slot is destroyed so old handles to a recycled index can be told apart from the new entity.
 class Entity {
 public:
 	Entity() = default;
-	Entity(const size_t id);
+	Entity(const u32 index, const u32 generation = 0);
 	bool operator==(const Entity& other) const;
-	size_t Id() const;
+	u32 Id() const;
+	u32 Generation() const;
 	static Entity Null();
 private:
-	size_t m_Id = -1;
+	u32 m_Index = -1;
+	u32 m_Generation = 0;
 };
 
-class EntityCompMask {
-public:
-	EntityCompMask() = default;
-
-	template<typename... Components>
-	static EntityCompMask From(Registry& registry);
-
-	bool operator==(const EntityCompMask& otherMask) const;
+// Entities that share the exact same component mask. In StorageMode::Archetype each pool in the
+// mask stores these entities' components back to back in the same order as the entities array.
+struct Archetype {
+	EntityCompMask mask;
+	std::vector<Entity> entities;
 
-	bool Empty() const;
-	bool IsSubsetOf(const EntityCompMask& superSet) const;
-	bool SharesAnyWith(const EntityCompMask& otherMask) const;
-	void Set(u32 index);
-	bool Test(u32 index) const;
-public:
-	std::bitset<MAX_COMPONENTS> m_Mask;
+	// Dense index of the first row inside each pool, indexed by component id
+	std::vector<u32> poolOffsets;
 };
 
 template<typename Component>
 Component& Registry::Add(const Entity entity) {
+	ASSERT(IsValid(entity), "Adding component to destroyed entity " << entity.Id());
+	ASSERT(!Has<Component>(entity), "Entity already has the component " << entity.Id());
 	const u32 compId = GetComponentId<Component>();
+	ComponentPool& pool = GetOrCreatePool<Component>();
 
-	for (int i = m_Pools.capacity(); i <= compId; i++) {
-		m_Pools.push_back(ComponentPool(sizeof(Component)));
-	}
-
+	m_ArchetypesDirty = true;
 	m_EntityCompMasks[entity.Id()].Set(compId);
-	return m_Pools[compId].Add<Component>(entity.Id());
+	Component& component = pool.Add<Component>(entity.Id());
+	pool.SetVersion(entity.Id(), m_Version);
+	OnMaskChanged(entity);
+	return component;
+}
+
+template<typename Component>
+void Registry::Remove(const Entity entity) {
+	ASSERT(IsValid(entity), "Removing component from destroyed entity " << entity.Id());
+	ASSERT(Has<Component>(entity), "Removing component the entity doesn't have " << entity.Id());
+	const u32 compId = GetComponentId<Component>();
+
+	m_ArchetypesDirty = true;
+	m_EntityCompMasks[entity.Id()].Reset(compId);
+	m_Pools[compId]->Remove(entity.Id());
+	OnMaskChanged(entity);
 }
 
 template<typename Component>
 Component& Registry::Get(const Entity entity) {
+	ASSERT(IsValid(entity), "Getting component of destroyed entity " << entity.Id());
+	const u32 compId = GetComponentId<Component>();
+	m_Pools[compId]->SetVersion(entity.Id(), m_Version);
+	return m_Pools[compId]->Get<Component>(entity.Id());
+}
+
+template<typename Component>
+const Component& Registry::Read(const Entity entity) {
+	ASSERT(IsValid(entity), "Reading component of destroyed entity " << entity.Id());
+	const u32 compId = GetComponentId<Component>();
+	return m_Pools[compId]->Get<Component>(entity.Id());
+}
+
+template<typename Component>
+void Registry::MarkChanged(const Entity entity) {
+	ASSERT(Has<Component>(entity), "Marking component the entity doesn't have " << entity.Id());
 	const u32 compId = GetComponentId<Component>();
-	return m_Pools[compId].Get<Component>(entity.Id());
+	m_Pools[compId]->SetVersion(entity.Id(), m_Version);
 }
 
 template<typename Component>
@@ -101,6 +274,23 @@ bool Registry::Has(const Entity entity) {
 	return m_EntityCompMasks[entity.Id()].Test(compId);
 }
 
+template<typename Component>
+void Registry::CopyComponents(std::vector<Component>& destination) {
+	static_assert(std::is_trivially_copyable_v<Component>, "Only trivially copyable components can be copied in bulk");
+	ComponentPool* pool = GetPool<Component>();
+
+	destination.resize(pool ? pool->Size() : 0);
+	if (pool) {
+		pool->CopyDense(destination.data());
+	}
+}
+
+template<typename Component>
+u32 Registry::DenseIndexOf(const Entity entity) {
+	ASSERT(Has<Component>(entity), "Entity doesn't have the component " << entity.Id());
+	return static_cast<u32>(m_Pools[GetComponentId<Component>()]->DenseIndexOf(entity.Id()));
+}
+
 template<typename Component>
 Component& Registry::GetAdd(const Entity entity) {
 	if (Has<Component>(entity)) {
@@ -109,18 +299,45 @@ Component& Registry::GetAdd(const Entity entity) {
 	return Add<Component>(entity);
 }
 
+template<typename... Components>
+void Registry::Reserve(const size_t entityCount) {
+	ReserveEntities(entityCount);
+	(GetOrCreatePool<Components>().Reserve(entityCount), ...);
+}
+
 template<typename Component>
-u32 Registry::GetComponentId() {
-	static u32 compId = m_ComponentCounter++;
+ComponentPool& Registry::GetOrCreatePool() {
+	const u32 compId = GetComponentId<Component>();
+
+	if (compId >= m_Pools.size()) {
+		m_Pools.resize(compId + 1);
+	}
+
+	if (!m_Pools[compId]) {
+		m_Pools[compId] = MakeScope<ComponentPool>(ComponentVTable::Of<Component>());
+	}
+
+	return *m_Pools[compId];
+}
+
+template<typename Component>
+ComponentPool* Registry::GetPool() {
+	const u32 compId = GetComponentId<Component>();
+	return compId < m_Pools.size() ? m_Pools[compId].get() : nullptr;
+}
+
+template<typename Component>
+constexpr u32 Registry::GetComponentId() {
+	constexpr u32 compId = ComponentIndex<Component>::value;
+	static_assert(compId != UNLISTED_COMPONENT, "Component type isn't listed in the application's ComponentIndex");
+	static_assert(compId == UNLISTED_COMPONENT || compId < MAX_COMPONENTS, "Too many component types, raise ECS_MAX_COMPONENTS");
 	return compId;
 }
 
+template<size_t Bits>
 template<typename... Components>
-EntityCompMask EntityCompMask::From(Registry& registry) {
-	EntityCompMask mask;
-	u32 componentIds[] = { registry.GetComponentId<Components>()... };
-	for (int i = 0; i < sizeof...(Components); i++) {
-		mask.Set(componentIds[i]);
-	}
+constexpr ComponentMask<Bits> ComponentMask<Bits>::Of() {
+	ComponentMask mask;
+	(mask.Set(Registry::GetComponentId<Components>()), ...);
 	return mask;
 }
\ No newline at end of file
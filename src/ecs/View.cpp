@@ -1,64 +1,139 @@
 #include "View.h"
 
-ViewIterator::ViewIterator(Registry& registry, const EntityCompMask mask, const EntityCompMask excludeMask, ViewFilter filter) 
-	: m_Registry(registry), m_Index(0), m_Mask(mask),
-      m_ExcludeMask(excludeMask), m_Filter(filter) { }
+ViewIterator::ViewIterator(Registry& registry, const EntityCompMask mask, const EntityCompMask excludeMask, ViewFilter filter,
+                           const ComponentPool* changedPool, u32 changedSince) 
+	: m_Registry(registry), m_Index(0), m_Archetype(0), m_PoolEntities(nullptr), m_PoolCompId(0), m_Mask(mask),
+      m_ExcludeMask(excludeMask), m_Filter(filter), m_ChangedPool(changedPool), m_ChangedSince(changedSince)
+{
+	if (m_Registry.GetStorageMode() == StorageMode::Archetype) return;
+
+	for (u32 compId = 0; compId < MAX_COMPONENTS; compId++) {
+		if (!m_Mask.Test(compId)) continue;
+
+		if (compId >= m_Registry.m_Pools.size() || !m_Registry.m_Pools[compId]) {
+			m_PoolEntities = nullptr;
+			return;
+		}
+
+		const std::vector<u32>& poolEntities = m_Registry.m_Pools[compId]->DenseEntities();
+		if (!m_PoolEntities || poolEntities.size() < m_PoolEntities->size()) {
+			m_PoolEntities = &poolEntities;
+			m_PoolCompId = compId;
+		}
+	}
+}
 
 void ViewIterator::SeekBegin() {
+	if (m_Registry.GetStorageMode() == StorageMode::Archetype) {
+		m_Registry.RefreshArchetypes();
+		m_Scope = IterationScope(m_Registry);
+		FindNextRow(0, 0);
+		return;
+	}
+
 	FindNextIndex(0);
 }
 
 void ViewIterator::SeekEnd() {
-	m_Index = m_Registry.GetEntityCount();
+	if (m_Registry.GetStorageMode() == StorageMode::Archetype) {
+		m_Registry.RefreshArchetypes();
+		m_Scope = IterationScope(m_Registry);
+		m_Archetype = m_Registry.m_Archetypes.size();
+		m_Index = 0;
+		return;
+	}
+
+	m_Index = PoolEntityCount();
 }
 
 Entity& ViewIterator::operator*() const {
-	return m_Registry.m_Entities[m_Index];
+	if (m_Registry.GetStorageMode() == StorageMode::Archetype) {
+		return m_Registry.m_Archetypes[m_Archetype].entities[m_Index];
+	}
+	return m_Registry.m_Entities[(*m_PoolEntities)[m_Index]];
 }
 
 ViewIterator& ViewIterator::operator++() {
 	m_Index++;
+
+	if (m_Registry.GetStorageMode() == StorageMode::Archetype) {
+		FindNextRow(m_Archetype, m_Index);
+		return *this;
+	}
+
 	FindNextIndex(m_Index);
 	return *this;
 }
 
 bool ViewIterator::operator==(const ViewIterator& other) const {
-	return (m_Index == other.m_Index && m_Mask.m_Mask == other.m_Mask.m_Mask);
+	return (m_Index == other.m_Index && m_Archetype == other.m_Archetype && m_Mask == other.m_Mask);
 }
 
 bool ViewIterator::operator!=(const ViewIterator& other) const {
-	return (m_Index != other.m_Index || m_Mask.m_Mask != other.m_Mask.m_Mask);
+	return !(*this == other);
 }
 
+bool ViewMatches(const ViewFilter filter, const EntityCompMask& mask, const EntityCompMask& excludeMask, const EntityCompMask& entityMask) {
+	switch (filter) 
+	{
+	case ViewFilter::With:
+		return mask.IsSubsetOf(entityMask);
+
+	case ViewFilter::Only:
+		return mask == entityMask;
+
+	case ViewFilter::WithWithout:
+		return mask.IsSubsetOf(entityMask) && !excludeMask.SharesAnyWith(entityMask);
+	}
+
+	return false;
+}
+
+bool ViewIterator::Matches(const EntityCompMask& entityMask) const {
+	return ViewMatches(m_Filter, m_Mask, m_ExcludeMask, entityMask);
+}
+
+// Walks the smallest pool so only entities owning its component are tested against the other pools
 void ViewIterator::FindNextIndex(const size_t startIndex) {
-	for (size_t i = startIndex; i < m_Registry.GetEntityCount(); i++) {
-		const EntityCompMask& entityMask = m_Registry.m_EntityCompMasks[i];
-
-		switch (m_Filter) 
-		{
-		case ViewFilter::With:
-			if (m_Mask.IsSubsetOf(entityMask)) {
-				m_Index = i;
-				return;
-			}
-			break;
+	const size_t poolEntityCount = PoolEntityCount();
 
-		case ViewFilter::Only:
-			if (m_Mask == entityMask) {
-				m_Index = i;
-				return;
-			}
-			break;
+	for (size_t i = startIndex; i < poolEntityCount; i++) {
+		const u32 entityIndex = (*m_PoolEntities)[i];
+		ASSERT(m_Registry.m_EntityCompMasks[entityIndex].Test(m_PoolCompId),
+		       "View visited entity " << entityIndex << " that doesn't own the component of its smallest pool");
+		if (Matches(m_Registry.m_EntityCompMasks[entityIndex]) && ChangedSince(entityIndex)) {
+			m_Index = i;
+			return;
+		}
+	}
+
+	m_Index = poolEntityCount;
+}
 
-		case ViewFilter::WithWithout:
-			if (m_Mask.IsSubsetOf(entityMask) && !m_ExcludeMask.SharesAnyWith(entityMask)) {
-				m_Index = i;
+// The mask test only runs once per archetype, every row inside a matching archetype is part of the view
+// unless the view also filters on changed components
+void ViewIterator::FindNextRow(const size_t startArchetype, size_t startRow) {
+	for (size_t i = startArchetype; i < m_Registry.m_Archetypes.size(); i++, startRow = 0) {
+		const Archetype& archetype = m_Registry.m_Archetypes[i];
+		if (!Matches(archetype.mask)) continue;
+
+		for (size_t row = startRow; row < archetype.entities.size(); row++) {
+			if (ChangedSince(archetype.entities[row].Id())) {
+				m_Archetype = i;
+				m_Index = row;
 				return;
 			}
-			break;
 		}
-
 	}
 
-	m_Index = m_Registry.GetEntityCount();
+	m_Archetype = m_Registry.m_Archetypes.size();
+	m_Index = 0;
+}
+
+bool ViewIterator::ChangedSince(const u32 entityIndex) const {
+	return !m_ChangedPool || m_ChangedPool->VersionOf(entityIndex) > m_ChangedSince;
+}
+
+size_t ViewIterator::PoolEntityCount() const {
+	return m_PoolEntities ? m_PoolEntities->size() : 0;
 }
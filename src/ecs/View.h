@@ -1,11 +1,19 @@
 #pragma once
+#include <algorithm>
+#include <array>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include "Registry.h"
 
 enum class ViewFilter { With, Only, WithWithout};
 
+bool ViewMatches(ViewFilter filter, const EntityCompMask& mask, const EntityCompMask& excludeMask, const EntityCompMask& entityMask);
+
 class ViewIterator {
 public:
-	ViewIterator(Registry& registry, const EntityCompMask mask, const EntityCompMask excludeMask, ViewFilter filter);
+	ViewIterator(Registry& registry, const EntityCompMask mask, const EntityCompMask excludeMask, ViewFilter filter,
+	             const ComponentPool* changedPool = nullptr, u32 changedSince = 0);
 	void SeekBegin();
 	void SeekEnd();
 	Entity& operator*() const;
@@ -13,13 +21,69 @@ public:
 	bool operator==(const ViewIterator& other) const;
 	bool operator!=(const ViewIterator& other) const;
 private:
+	bool Matches(const EntityCompMask& entityMask) const;
+	bool ChangedSince(const u32 entityIndex) const;
 	void FindNextIndex(const size_t startIndex);
+	void FindNextRow(const size_t startArchetype, size_t startRow);
+	size_t PoolEntityCount() const;
 private:
 	Registry& m_Registry;
 	size_t m_Index;
+	size_t m_Archetype;
+
+	// Dense entity list of the smallest pool in the view, the only entities that can possibly match.
+	// Null when one of the view's components has never been added, meaning nothing can match.
+	const std::vector<u32>* m_PoolEntities;
+	u32 m_PoolCompId;
 	EntityCompMask m_Mask;
 	EntityCompMask m_ExcludeMask;
 	ViewFilter m_Filter;
+
+	// When set, only entities whose component in this pool was written after m_ChangedSince are visited
+	const ComponentPool* m_ChangedPool;
+	u32 m_ChangedSince;
+
+	// Taken once the iterator is seeked into the archetypes, which is after the only repack it may trigger
+	IterationScope m_Scope;
+};
+
+// Wraps a ViewIterator and dereferences to the entity together with its components,
+// e.g. for (auto [entity, toWorld, trans] : View<LocalToWorld, Transform>(registry).Each())
+template<typename... Components>
+class ViewEachIterator {
+public:
+	using Pools = std::array<ComponentPool*, sizeof...(Components)>;
+
+	ViewEachIterator(const ViewIterator& iterator, const Pools& pools) : m_Iterator(iterator), m_Pools(pools) { }
+
+	std::tuple<Entity, Components&...> operator*() const {
+		return Fetch(*m_Iterator, std::index_sequence_for<Components...>());
+	}
+
+	ViewEachIterator& operator++() {
+		++m_Iterator;
+		return *this;
+	}
+
+	bool operator==(const ViewEachIterator& other) const { return m_Iterator == other.m_Iterator; }
+	bool operator!=(const ViewEachIterator& other) const { return m_Iterator != other.m_Iterator; }
+private:
+	template<size_t... Indices>
+	std::tuple<Entity, Components&...> Fetch(const Entity entity, std::index_sequence<Indices...>) const {
+		return { entity, m_Pools[Indices]->template Get<Components>(entity.Id())... };
+	}
+private:
+	ViewIterator m_Iterator;
+	Pools m_Pools;
+};
+
+template<typename... Components>
+struct ViewEachRange {
+	ViewEachIterator<Components...> m_Begin;
+	ViewEachIterator<Components...> m_End;
+
+	ViewEachIterator<Components...> begin() const { return m_Begin; }
+	ViewEachIterator<Components...> end() const { return m_End; }
 };
 
 template<typename... Components>
@@ -28,37 +92,118 @@ public:
 
 	View(Registry& registry) : m_Registry(registry), m_Filter(ViewFilter::With)
 	{
-		m_Mask = EntityCompMask::From<Components...>(m_Registry);
+		m_Mask = EntityCompMask::Of<Components...>();
+		m_Pools = { m_Registry.GetPool<Components>()... };
 	}
 
 	View Only() {
-		m_Mask = EntityCompMask::From<Components...>(m_Registry);
 		m_Filter = ViewFilter::Only;
 		return *this;
 	}
 
 	template<typename... Excluded>
 	View Exclude() {
-		m_ExcludeMask = EntityCompMask::From<Excluded...>(m_Registry);
+		m_ExcludeMask = EntityCompMask::Of<Excluded...>();
 		m_Filter = ViewFilter::WithWithout;
 		return *this;
 	}
 
+	// Restricts the view to entities whose Component was written after sinceVersion, see Registry::AdvanceVersion
+	template<typename Component>
+	View Changed(const u32 sinceVersion) {
+		static_assert((std::is_same_v<Component, Components> || ...), "Changed component must be part of the view");
+		m_ChangedPool = m_Registry.GetPool<Component>();
+		m_ChangedCompId = m_Registry.GetComponentId<Component>();
+		m_ChangedSince = sinceVersion;
+		return *this;
+	}
+
 	const ViewIterator begin() const {
-		ViewIterator iterator(m_Registry, m_Mask, m_ExcludeMask, m_Filter);
+		ViewIterator iterator(m_Registry, m_Mask, m_ExcludeMask, m_Filter, m_ChangedPool, m_ChangedSince);
 		iterator.SeekBegin();
 		return iterator;
 	}
 
 	const ViewIterator end() const {
-		ViewIterator iterator(m_Registry, m_Mask, m_ExcludeMask, m_Filter);
+		ViewIterator iterator(m_Registry, m_Mask, m_ExcludeMask, m_Filter, m_ChangedPool, m_ChangedSince);
 		iterator.SeekEnd();
 		return iterator;
 	}
 
+	// Range yielding std::tuple<Entity, Components&...> so the result can be used with structured bindings
+	ViewEachRange<Components...> Each() const {
+		return { { begin(), m_Pools }, { end(), m_Pools } };
+	}
+
+	// Calls func(Entity, Components&...) for every entity in the view with the pools resolved up front
+	template<typename Func>
+	void Each(Func&& func) const {
+		if (m_Registry.GetStorageMode() == StorageMode::Archetype) {
+			m_Registry.RefreshArchetypes();
+			const IterationScope scope(m_Registry);
+			for (const Archetype& archetype : m_Registry.m_Archetypes) {
+				if (ViewMatches(m_Filter, m_Mask, m_ExcludeMask, archetype.mask)) {
+					EachInArchetype(archetype, func, std::index_sequence_for<Components...>());
+				}
+			}
+			return;
+		}
+
+		for (const Entity entity : *this) {
+			EachInSparse(entity, func, std::index_sequence_for<Components...>());
+		}
+	}
+
+private:
+	// The rows of an archetype are stored back to back in each of its pools, so within a page every component
+	// is a plain array. Rows are walked in runs that end wherever one of the pools crosses into its next page.
+	template<typename Func, size_t... Indices>
+	void EachInArchetype(const Archetype& archetype, Func& func, std::index_sequence<Indices...>) const {
+		const u32 compIds[] = { m_Registry.GetComponentId<Components>()... };
+		const size_t rowCount = archetype.entities.size();
+
+		size_t row = 0;
+		while (row < rowCount) {
+			const size_t denseIndices[] = { (archetype.poolOffsets[compIds[Indices]] + row)... };
+
+			size_t runLength = rowCount - row;
+			for (size_t i = 0; i < sizeof...(Components); i++) {
+				runLength = std::min(runLength, m_Pools[i]->ContiguousFrom(denseIndices[i]));
+			}
+
+			void* columns[] = { m_Pools[Indices]->GetDenseAddress(denseIndices[Indices])... };
+			const Entity* entities = archetype.entities.data() + row;
+
+			if (m_ChangedPool) {
+				const size_t changedOffset = archetype.poolOffsets[m_ChangedCompId] + row;
+				for (size_t i = 0; i < runLength; i++) {
+					if (m_ChangedPool->VersionAtDense(changedOffset + i) > m_ChangedSince) {
+						func(entities[i], static_cast<Components*>(columns[Indices])[i]...);
+					}
+				}
+			}
+			else {
+				for (size_t i = 0; i < runLength; i++) {
+					func(entities[i], static_cast<Components*>(columns[Indices])[i]...);
+				}
+			}
+
+			row += runLength;
+		}
+	}
+
+	template<typename Func, size_t... Indices>
+	void EachInSparse(const Entity entity, Func& func, std::index_sequence<Indices...>) const {
+		func(entity, m_Pools[Indices]->template Get<Components>(entity.Id())...);
+	}
+
 private:
 	Registry& m_Registry;
+	std::array<ComponentPool*, sizeof...(Components)> m_Pools;
 	EntityCompMask m_Mask;
 	EntityCompMask m_ExcludeMask;
 	ViewFilter m_Filter;
+	const ComponentPool* m_ChangedPool = nullptr;
+	u32 m_ChangedCompId = 0;
+	u32 m_ChangedSince = 0;
 };
@@ -12,6 +12,10 @@
 #include "core/Components.h"
 #include "core/Serializer.h"
 #include "core/CameraSystem.h"
+#include "core/JobSystem.h"
+#include "core/MatrixKernels.h"
+#include "core/TransformSystem.h"
+#include "renderer/GLState.h"
 #include "renderer/Renderer.h"
 #include "SceneCamera.h"
 #include "core/Primatives.h"
@@ -114,7 +118,7 @@ void Editor::DrawScene(Registry& registry) {
 	s_CurRenderingWinSize = windowSize;
 
 	Renderer::NewGizmosFrame();
-	glDisable(GL_DEPTH_TEST);
+	GLState::SetDepthTest(false);
 	
 	if (Input::OnKeyPress(GLFW_KEY_M)) {
 		s_ShowShadowMap = !s_ShowShadowMap;		
@@ -130,15 +134,21 @@ void Editor::DrawScene(Registry& registry) {
 	
 	Entity selectedEntity = Selection::SelectedEntity();
 
-	if (selectedEntity != Entity::Null()) {
-		glm::vec3 gizmoPos = registry.Get<LocalToWorld>(selectedEntity).ToTransform().position;
+	// Static entities can't be moved, so they get no handle
+	if (registry.IsValid(selectedEntity) && !registry.Has<Static>(selectedEntity)) {
+		const glm::vec3 worldPos = registry.Read<LocalToWorld>(selectedEntity).ToTransform().position;
+		glm::vec3 gizmoPos = worldPos;
 		s_TransGizmos->TransformHandle(s_EditorRegistry, &gizmoPos);
-		Entity parent = registry.Get<Parent>(selectedEntity).entity;
-		glm::mat4 invParentLTW = glm::inverse(registry.Get<LocalToWorld>(parent).matrix);
-		registry.Get<Transform>(selectedEntity).position = invParentLTW * glm::vec4(gizmoPos, 1.0f);
+
+		// Writing back every frame would mark the whole subtree dirty and let the inverse round trip drift
+		if (gizmoPos != worldPos) {
+			Entity parent = registry.Read<Parent>(selectedEntity).entity;
+			AffineMatrix invParentLTW = registry.Read<LocalToWorld>(parent).matrix.Inverse();
+			registry.Get<Transform>(selectedEntity).position = invParentLTW.TransformPoint(gizmoPos);
+		}
 	}
 
-	glEnable(GL_DEPTH_TEST);
+	GLState::SetDepthTest(true);
 	Renderer::EndGizmosFrame();
 
 	Selection::Update(registry, s_EditorRegistry);
@@ -166,6 +176,16 @@ void Editor::DrawWorld(Registry& registry) {
 		s_ShowInspectorEnvironment = false;
 	}
 
+	ImGui::Text("Transforms updated: %u (%s)", TransformSystem::GetUpdatedCount(), MatrixKernels::InstructionSet());
+	ImGui::Text("Transform update: %.3f ms on %u threads", TransformSystem::GetUpdateMilliseconds(), JobSystem::WorkerCount() + 1);
+
+	const Renderer::RenderStats& stats = Renderer::GetStats();
+	ImGui::Text("Draw calls: %u, %u commands, %u instances", stats.drawCalls, stats.commands, stats.instances);
+	ImGui::Text("Binds: %u shaders, %u materials, %u meshes", stats.shaderBinds, stats.materialBinds, stats.vaoBinds);
+
+	const GLState::Stats& stateStats = GLState::GetLastFrameStats();
+	ImGui::Text("GL state calls: %u issued, %u skipped", stateStats.issuedCalls, stateStats.skippedCalls);
+
 	auto rootView = View<LocalToWorld, Transform, Children>(registry).Exclude<Parent>();
 	for (Entity& entity : rootView) {
 		DrawEntityHierarchy(registry, entity);
@@ -196,7 +216,7 @@ void Editor::DrawEntityHierarchy(Registry& registry, Entity entity) {
 	}
 
 	if (open && !isLeaf) {
-		for (Entity& child : registry.Get<Children>(entity).entities) {
+		for (Entity& child : registry.Read<Children>(entity).entities) {
 			DrawEntityHierarchy(registry, child);
 		}
 	}
@@ -264,12 +284,16 @@ void Editor::DrawInspector(Registry& registry) {
 
 	Entity selectedEntity = Selection::SelectedEntity();
 
-	if (selectedEntity != Entity::Null()) {
+	if (registry.IsValid(selectedEntity)) {
 		std::string entityName = "Selected Entity ";
 		entityName.append(std::to_string(selectedEntity.Id()));
 		ImGui::Text(entityName.c_str());
 
-		if (registry.Has<Transform>(selectedEntity)) {
+		if (registry.Has<Static>(selectedEntity) && registry.Has<Transform>(selectedEntity)) {
+			const glm::vec3& position = registry.Read<Transform>(selectedEntity).position;
+			ImGui::Text("Static %.1f %.1f %.1f", position.x, position.y, position.z);
+		}
+		else if (registry.Has<Transform>(selectedEntity)) {
 			auto* trans = &registry.Get<Transform>(selectedEntity);
 			ImGui::PushItemWidth(60);
 			ImGui::DragFloat("x", &trans->position.x, 0.1f);
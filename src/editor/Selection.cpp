@@ -1,5 +1,6 @@
 #include <imgui/imgui.h>
 #include "GuiUtils.h"
+#include "renderer/GLState.h"
 #include "renderer/Shader.h"
 #include "renderer/renderer.h"
 #include "ecs/View.h"
@@ -32,8 +33,8 @@ void Selection::Update(Registry& gameRegistry, Registry& gizmoRegistry) {
 		{
 			const auto view = View<LocalToWorld, MeshRenderer>(gameRegistry);
 			for (const auto entity : view) {
-				auto& toWorld = gameRegistry.Get<LocalToWorld>(entity);
-				auto& meshRenderer = gameRegistry.Get<MeshRenderer>(entity);
+				auto& toWorld = gameRegistry.Read<LocalToWorld>(entity);
+				auto& meshRenderer = gameRegistry.Read<MeshRenderer>(entity);
 				s_SelectionShader.SetInt("entityId", static_cast<i32>(entity.Id()));
 				Renderer::DrawMesh(meshRenderer, toWorld, s_SelectionShader);
 			}
@@ -41,17 +42,17 @@ void Selection::Update(Registry& gameRegistry, Registry& gizmoRegistry) {
 
 		i32 gizmoIdOffset = gameRegistry.GetEntityCount();
 
-		glDisable(GL_DEPTH_TEST);
+		GLState::SetDepthTest(false);
 		{
 			const auto view = View<Transform, MeshRenderer>(gizmoRegistry);
 			for (const auto entity : view) {
-				auto& transform = gizmoRegistry.Get<Transform>(entity);
-				auto& meshRenderer = gizmoRegistry.Get<MeshRenderer>(entity);
+				auto& transform = gizmoRegistry.Read<Transform>(entity);
+				auto& meshRenderer = gizmoRegistry.Read<MeshRenderer>(entity);
 				s_SelectionShader.SetInt("entityId", static_cast<i32>(entity.Id() + gizmoIdOffset));
 				Renderer::DrawMesh(meshRenderer, LocalToWorld::FromTransform(transform), s_SelectionShader);
 			}
 		}
-		glEnable(GL_DEPTH_TEST);
+		GLState::SetDepthTest(true);
 		
 		const glm::vec2 pixelCoords = sceneRect.RelativeCoordinates(GuiUtils::MousePosition());
 		const i32 possibleEntityId = s_SelectionBuffer.ReadPixel(pixelCoords);
@@ -3,6 +3,7 @@
 #include "GuiUtils.h"
 #include "editor/SceneCamera.h"
 #include "core/CameraSystem.h"
+#include "renderer/GLState.h"
 #include "renderer/Renderer.h"
 #include "renderer/Shader.h"
 #include "TransformGizmos.h"
@@ -81,9 +82,8 @@ glm::vec3 TransformGizmos::TransformArrow(Entity gizmoEntity, const glm::vec3& p
 		return pos;
 	}
 	
-	i32 viewportDimensions[4];
-	glGetIntegerv(GL_VIEWPORT, viewportDimensions);
-	glm::vec2 screenSize(viewportDimensions[2], viewportDimensions[3]);
+	const glm::i32vec4& viewport = GLState::GetViewport();
+	glm::vec2 screenSize(viewport.z, viewport.w);
 
 	glm::vec2 mousePos = GuiUtils::MousePosition();
 
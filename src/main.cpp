@@ -10,7 +10,10 @@
 #include "renderer/CubeMap.h"
 #include "core/CameraSystem.h"
 #include "core/TransformSystem.h"
+#include "core/JobSystem.h"
+#include "core/SystemScheduler.h"
 #include "renderer/ShadowMapper.h"
+#include "renderer/GLState.h"
 #include "ecs/Registry.h"
 
 Registry mainRegistry;
@@ -42,7 +45,11 @@ int main() {
 		return -1;
 	}
 
+	// Before anything touches GL state, so the cache starts out matching the context
+	GLState::Init();
+
 	SetupEnviroment();
+	JobSystem::Init();
 	CameraSystem::Init();
 	Input::Init(window);
 	Renderer::Init();
@@ -55,18 +62,34 @@ int main() {
 	// auto house = Model::Instantiate("Assets/House/scene.gltf.model");
 	// house.Get<Transform>().scale = glm::vec3(0.01f);
 
-	while (!glfwWindowShouldClose(window)) {
-		Input::Update(window);
-		CameraSystem::Update();
-		TransformSystem::Update(mainRegistry);
-		Editor::OnPreRenderUpdate();
-		Renderer::NewFrame(mainRegistry);
-		Renderer::RenderScene(mainRegistry);
+	// Everything registered so far touches GL, the window or issues its own ParallelFor, so these still run
+	// in this order. Systems without those restrictions run next to each other when their components allow it.
+	SystemScheduler scheduler;
+	scheduler.Add("Input", [window](Registry&) { Input::Update(window); }).MainThread();
+	scheduler.Add("Camera", [](Registry&) { CameraSystem::Update(); }).MainThread();
+	scheduler.Add("Transform", TransformSystem::Update)
+		.Reads<Transform, Parent, Children, Static, MeshRenderer>()
+		.Writes<LocalToWorld, NormalMatrix>()
+		.MainThread();
+	scheduler.Add("EditorPreRender", [](Registry&) { Editor::OnPreRenderUpdate(); }).MainThread();
+	scheduler.Add("Render", [](Registry& registry) {
+		Renderer::NewFrame(registry);
+		Renderer::RenderScene();
 		Renderer::EndFrame();
-		Editor::OnPostRenderUpdate(mainRegistry);
+	})
+		.Reads<LocalToWorld, NormalMatrix, Transform, MeshRenderer, Static>()
+		.MainThread();
+	scheduler.Add("EditorPostRender", Editor::OnPostRenderUpdate)
+		.Reads<LocalToWorld, MeshRenderer, Static, Parent, Children>()
+		.Writes<Transform>()
+		.MainThread();
+
+	while (!glfwWindowShouldClose(window)) {
+		scheduler.Run(mainRegistry);
 		glfwSwapBuffers(window);
 	}
 
+	JobSystem::Shutdown();
 	glfwTerminate();
 }
 
@@ -43,3 +43,26 @@ f32 Bounds::MaxLength() const {
 
 	return max;
 }
+
+void Bounds::Encapsulate(const glm::vec3& point) {
+	m_Min = glm::min(m_Min, point);
+	m_Max = glm::max(m_Max, point);
+}
+
+// Each world axis picks the smaller and larger product of the matrix entry and the box extent on every
+// local axis, which gives the tight box without transforming all eight corners.
+Bounds Bounds::Transformed(const AffineMatrix& matrix) const {
+	Bounds result;
+	result.m_Min = matrix.Translation();
+	result.m_Max = matrix.Translation();
+
+	for (i32 column = 0; column < 3; column++) {
+		const glm::vec3 axis = matrix.Axis(column);
+		const glm::vec3 a = axis * m_Min[column];
+		const glm::vec3 b = axis * m_Max[column];
+		result.m_Min += glm::min(a, b);
+		result.m_Max += glm::max(a, b);
+	}
+
+	return result;
+}
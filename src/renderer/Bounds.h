@@ -1,11 +1,18 @@
 #pragma once
 #include <glm/glm.hpp>
+#include "core/AffineMatrix.h"
 #include "core/Base.h"
 
 class Bounds {
 public:
+	Bounds() = default;
 	Bounds(const glm::vec3* points, const size_t size);
 
+	void Encapsulate(const glm::vec3& point);
+
+	// Axis aligned box enclosing this box after it has been transformed by the matrix
+	Bounds Transformed(const AffineMatrix& matrix) const;
+
 	f32 XLength() const { return m_Max.x - m_Min.x; }
 	f32 YLength() const { return m_Max.y - m_Min.y; }
 	f32 ZLength() const { return m_Max.z - m_Min.z; }
@@ -13,6 +20,6 @@ public:
 	
 	glm::vec3 Center() const { return (m_Max + m_Min) / 2.0f; }
 
-	glm::vec3 m_Min;
-	glm::vec3 m_Max;
+	glm::vec3 m_Min = glm::vec3(0);
+	glm::vec3 m_Max = glm::vec3(0);
 };
\ No newline at end of file
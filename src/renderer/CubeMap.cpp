@@ -1,6 +1,7 @@
 #include <cassert>
 #include <stb/stb_image.h>
 #include <glad/glad.h>
+#include "GLState.h"
 #include "CubeMap.h"
 #include <iostream>
 
@@ -16,7 +17,7 @@ Ref<CubeMap> CubeMap::Load(const std::array<std::string, 6>& images) {
 
     u32 id;
     glGenTextures(1, &id);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, id);
+    GLState::BindTexture(GL_TEXTURE_CUBE_MAP, id);
 
     for (size_t i = 0; i < images.size(); i++) {
 		i32 width, height, numChannels;
@@ -48,9 +49,9 @@ CubeMap::CubeMap(const std::string& key, u32 id) {
 CubeMap::~CubeMap() {
     m_ActiveCubemaps.erase(m_Key);
     glDeleteTextures(1, &m_Id);
+    GLState::OnTextureDeleted(m_Id);
 }
 
 void CubeMap::Bind(const i32 textureUnit) const {
-    glActiveTexture(GL_TEXTURE0 + textureUnit);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, m_Id);
+    GLState::BindTexture(textureUnit, GL_TEXTURE_CUBE_MAP, m_Id);
 }
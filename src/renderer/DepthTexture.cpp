@@ -1,9 +1,10 @@
 #include <glad/glad.h>
+#include "GLState.h"
 #include "DepthTexture.h"
 
 DepthTexture::DepthTexture(const u32 width, const u32 height) {
 	glGenTextures(1, &m_Id);
-	glBindTexture(GL_TEXTURE_2D, m_Id);
+	GLState::BindTexture(GL_TEXTURE_2D, m_Id);
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, width, height, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
 
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
@@ -14,18 +15,17 @@ DepthTexture::DepthTexture(const u32 width, const u32 height) {
 	float borderColor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
 	glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
 
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GLState::BindTexture(GL_TEXTURE_2D, 0);
 }
 
 void DepthTexture::Bind(const i32 textureUnit) const {
-	glActiveTexture(GL_TEXTURE0 + textureUnit);
-	glBindTexture(GL_TEXTURE_2D, m_Id);
+	GLState::BindTexture(textureUnit, GL_TEXTURE_2D, m_Id);
 }
 
 void DepthTexture::Resize(const glm::i32vec2 size) const {
-	glBindTexture(GL_TEXTURE_2D, m_Id);
+	GLState::BindTexture(GL_TEXTURE_2D, m_Id);
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, size.x, size.y, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GLState::BindTexture(GL_TEXTURE_2D, 0);
 }
 
 void DepthTexture::AttachToActiveFrameBuffer() const {
@@ -1,4 +1,5 @@
 #include <glad/glad.h>
+#include "GLState.h"
 #include "editor/Editor.h"
 #include "FrameBuffer.h"
 
@@ -9,10 +10,10 @@ FrameBuffer::FrameBuffer(const glm::i32vec2& size, const Format format)
 	: m_Format(format), m_Size(size)
 {
 	glGenFramebuffers(1, &m_Fbo);
-	glBindFramebuffer(GL_FRAMEBUFFER, m_Fbo);
+	GLState::BindFramebuffer(m_Fbo);
 
 	glGenTextures(1, &m_Texture);
-	glBindTexture(GL_TEXTURE_2D, m_Texture);
+	GLState::BindTexture(GL_TEXTURE_2D, m_Texture);
 
 	switch (m_Format) {
 		case HDR:
@@ -28,14 +29,14 @@ FrameBuffer::FrameBuffer(const glm::i32vec2& size, const Format format)
 
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GLState::BindTexture(GL_TEXTURE_2D, 0);
 
 	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_Texture, 0);
 
 	m_DepthTexture = DepthTexture(m_Size.x, m_Size.y);
 	m_DepthTexture.AttachToActiveFrameBuffer();
 
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLState::BindFramebuffer(0);
 }
 
 void FrameBuffer::BindAndClear() {
@@ -44,23 +45,18 @@ void FrameBuffer::BindAndClear() {
 }
 
 void FrameBuffer::Bind() {
-	i32 viewportDimensions[4];
-	glGetIntegerv(GL_VIEWPORT, viewportDimensions);
-	m_PrevViewportSize.x = viewportDimensions[2];
-	m_PrevViewportSize.y = viewportDimensions[3];
-
-	glViewport(0, 0, m_Size.x, m_Size.y);
-	glBindFramebuffer(GL_FRAMEBUFFER, m_Fbo);
+	m_PrevViewport = GLState::GetViewport();
+	GLState::Viewport({ 0, 0, m_Size.x, m_Size.y });
+	GLState::BindFramebuffer(m_Fbo);
 }
 
 void FrameBuffer::Unbind() const {
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
-	glViewport(0, 0, m_PrevViewportSize.x, m_PrevViewportSize.y);
+	GLState::BindFramebuffer(0);
+	GLState::Viewport(m_PrevViewport);
 }
 
 void FrameBuffer::BindTexture(const i32 textureUnit) const {
-	glActiveTexture(GL_TEXTURE0 + textureUnit);
-	glBindTexture(GL_TEXTURE_2D, m_Texture);
+	GLState::BindTexture(textureUnit, GL_TEXTURE_2D, m_Texture);
 }
 
 void FrameBuffer::RedIntegerFill(const i32 fillValue) const {
@@ -71,7 +67,7 @@ void FrameBuffer::Resize(const glm::i32vec2& size) {
 	m_Size = size;
 	m_DepthTexture.Resize(size);
 
-	glBindTexture(GL_TEXTURE_2D, m_Texture);
+	GLState::BindTexture(GL_TEXTURE_2D, m_Texture);
 	switch (m_Format) {
 		case HDR:
 			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, m_Size.x, m_Size.y, 0, GL_RGB, GL_FLOAT, NULL);
@@ -83,12 +79,13 @@ void FrameBuffer::Resize(const glm::i32vec2& size) {
 			glTexImage2D(GL_TEXTURE_2D, 0, GL_R32I, m_Size.x, m_Size.y, 0, GL_RED_INTEGER, GL_UNSIGNED_BYTE, nullptr);
 			break;
 	}
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GLState::BindTexture(GL_TEXTURE_2D, 0);
 }
 
 void FrameBuffer::BlitToScreen() const {
+	// Both bindings end up back at the default framebuffer, which is what the cache expects
+	GLState::BindFramebuffer(0);
 	glBindFramebuffer(GL_READ_FRAMEBUFFER, m_Fbo);
-	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
 	glBlitFramebuffer(0, 0, m_Size.x, m_Size.y, 0, 0, m_Size.x, m_Size.y, GL_COLOR_BUFFER_BIT, GL_NEAREST);
 	glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
 }
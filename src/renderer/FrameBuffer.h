@@ -28,7 +28,7 @@ private:
 	u32 m_Texture;
 	Format m_Format;
 	glm::i32vec2 m_Size;
-	glm::i32vec2 m_PrevViewportSize;
+	glm::i32vec4 m_PrevViewport;
 	DepthTexture m_DepthTexture;
 };
 
@@ -0,0 +1,55 @@
+#pragma once
+#include <vector>
+#include "core/Base.h"
+#include "core/Components.h"
+#include "Bounds.h"
+
+class Material;
+
+// Everything needed to draw one mesh of an entity without touching the registry
+struct DrawItem {
+	// Index into FramePacket::worldMatrices and FramePacket::normalMatrices
+	u32 matrixIndex;
+	u32 normalIndex;
+
+	u32 vao;
+	// Mesh::m_Id, heap meshes share their VAO so this is what tells them apart
+	u32 mesh;
+	u32 firstIndex;
+	i32 baseVertex;
+	u32 indexCount;
+	Material* material;
+
+	// World space
+	Bounds bounds;
+};
+
+// Render relevant copy of the scene taken once per frame. The renderer only reads the packet, so the
+// registry is free to be updated for the next frame while this one is being submitted.
+struct FramePacket {
+	// Bulk copy of the LocalToWorld pool
+	std::vector<LocalToWorld> worldMatrices;
+	std::vector<NormalMatrix> normalMatrices;
+
+	// Items of entities without the Static tag, gathered every frame
+	std::vector<DrawItem> items;
+
+	// Items of static entities, only copied in again when the renderer's static list was rebuilt
+	std::vector<DrawItem> staticItems;
+	u32 staticItemsVersion = 0;
+
+	const LocalToWorld& WorldMatrix(const DrawItem& item) const { return worldMatrices[item.matrixIndex]; }
+	const NormalMatrix& NormalMatrixOf(const DrawItem& item) const { return normalMatrices[item.normalIndex]; }
+
+	template<typename Func>
+	void ForEachItem(Func&& func) const {
+		for (const DrawItem& item : staticItems) func(item);
+		for (const DrawItem& item : items) func(item);
+	}
+
+	void Clear() {
+		worldMatrices.clear();
+		normalMatrices.clear();
+		items.clear();
+	}
+};
@@ -0,0 +1,140 @@
+#include <glad/glad.h>
+#include "GLState.h"
+
+void GLState::Init() {
+	glGetIntegerv(GL_VIEWPORT, &m_Viewport[0]);
+
+	glUseProgram(0);
+	glBindVertexArray(0);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glActiveTexture(GL_TEXTURE0);
+	m_ActiveUnit = 0;
+
+	glDisable(GL_BLEND);
+	glBlendFunc(GL_ONE, GL_ZERO);
+	glDisable(GL_DEPTH_TEST);
+	glDepthFunc(GL_LESS);
+	glDepthMask(GL_TRUE);
+
+	m_Program = 0;
+	m_Vao = 0;
+	m_Framebuffer = 0;
+	m_Blend = false;
+	m_BlendSource = GL_ONE;
+	m_BlendDestination = GL_ZERO;
+	m_DepthTest = false;
+	m_DepthFunc = GL_LESS;
+	m_DepthMask = true;
+}
+
+void GLState::UseProgram(const u32 program) {
+	if (!Changes(program != m_Program)) return;
+	glUseProgram(program);
+	m_Program = program;
+}
+
+void GLState::BindVertexArray(const u32 vao) {
+	if (!Changes(vao != m_Vao)) return;
+	glBindVertexArray(vao);
+	m_Vao = vao;
+}
+
+void GLState::BindFramebuffer(const u32 framebuffer) {
+	if (!Changes(framebuffer != m_Framebuffer)) return;
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	m_Framebuffer = framebuffer;
+}
+
+void GLState::BindTexture(const u32 unit, const u32 target, const u32 texture) {
+	ASSERT(unit < MaxTextureUnits, "Texture unit " << unit << " isn't tracked");
+	u32& bound = m_Textures[TargetIndex(target)][unit];
+	if (!Changes(texture != bound)) return;
+
+	if (unit != m_ActiveUnit) {
+		glActiveTexture(GL_TEXTURE0 + unit);
+		m_ActiveUnit = unit;
+	}
+	glBindTexture(target, texture);
+	bound = texture;
+}
+
+void GLState::BindTexture(const u32 target, const u32 texture) {
+	BindTexture(m_ActiveUnit, target, texture);
+}
+
+void GLState::OnTextureDeleted(const u32 texture) {
+	for (auto& units : m_Textures) {
+		for (u32& bound : units) {
+			if (bound == texture) bound = 0;
+		}
+	}
+}
+
+void GLState::Viewport(const glm::i32vec4& viewport) {
+	if (!Changes(viewport != m_Viewport)) return;
+	glViewport(viewport.x, viewport.y, viewport.z, viewport.w);
+	m_Viewport = viewport;
+}
+
+void GLState::SetBlend(const bool enabled) {
+	if (!Changes(enabled != m_Blend)) return;
+	Enable(GL_BLEND, enabled);
+	m_Blend = enabled;
+}
+
+void GLState::BlendFunc(const u32 source, const u32 destination) {
+	if (!Changes(source != m_BlendSource || destination != m_BlendDestination)) return;
+	glBlendFunc(source, destination);
+	m_BlendSource = source;
+	m_BlendDestination = destination;
+}
+
+void GLState::SetDepthTest(const bool enabled) {
+	if (!Changes(enabled != m_DepthTest)) return;
+	Enable(GL_DEPTH_TEST, enabled);
+	m_DepthTest = enabled;
+}
+
+void GLState::DepthFunc(const u32 func) {
+	if (!Changes(func != m_DepthFunc)) return;
+	glDepthFunc(func);
+	m_DepthFunc = func;
+}
+
+void GLState::DepthMask(const bool enabled) {
+	if (!Changes(enabled != m_DepthMask)) return;
+	glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+	m_DepthMask = enabled;
+}
+
+void GLState::NewFrame() {
+	m_LastFrameStats = m_Stats;
+	m_Stats = {};
+}
+
+u32 GLState::TargetIndex(const u32 target) {
+	switch (target) {
+		case GL_TEXTURE_2D: return 0;
+		case GL_TEXTURE_3D: return 1;
+		case GL_TEXTURE_CUBE_MAP: return 2;
+	}
+	ASSERT(false, "Texture target " << target << " isn't tracked");
+	return 0;
+}
+
+void GLState::Enable(const u32 capability, const bool enabled) {
+	if (enabled) {
+		glEnable(capability);
+	} else {
+		glDisable(capability);
+	}
+}
+
+bool GLState::Changes(const bool changed) {
+	if (changed) {
+		m_Stats.issuedCalls++;
+	} else {
+		m_Stats.skippedCalls++;
+	}
+	return changed;
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <glm/glm.hpp>
+#include "core/Base.h"
+
+// Shadow copy of the GL state the renderer changes most often. Every change goes through here, so a call
+// that wouldn't change anything is dropped before reaching the driver, and reading the state back never
+// needs a glGet. Code changing this state directly must leave it as it found it, like the ImGui backend does.
+class GLState {
+public:
+	static constexpr u32 MaxTextureUnits = 32;
+
+	// Puts every tracked value into a known state, the viewport is the only one queried
+	static void Init();
+
+	static void UseProgram(u32 program);
+	static void BindVertexArray(u32 vao);
+	static void BindFramebuffer(u32 framebuffer);
+
+	// Target is GL_TEXTURE_2D, GL_TEXTURE_3D or GL_TEXTURE_CUBE_MAP
+	static void BindTexture(u32 unit, u32 target, u32 texture);
+	// Binds to whichever unit is active, for uploading data and setting parameters
+	static void BindTexture(u32 target, u32 texture);
+	// Deleted textures are unbound by GL, their id may come back for a new texture
+	static void OnTextureDeleted(u32 texture);
+
+	static void Viewport(const glm::i32vec4& viewport);
+	static const glm::i32vec4& GetViewport() { return m_Viewport; }
+
+	static void SetBlend(bool enabled);
+	static void BlendFunc(u32 source, u32 destination);
+	static void SetDepthTest(bool enabled);
+	static void DepthFunc(u32 func);
+	static void DepthMask(bool enabled);
+
+	struct Stats {
+		u32 issuedCalls;
+		u32 skippedCalls;
+	};
+
+	// Counts of the previous frame, the current one starts from zero
+	static void NewFrame();
+	static const Stats& GetLastFrameStats() { return m_LastFrameStats; }
+private:
+	static u32 TargetIndex(u32 target);
+	static void Enable(u32 capability, bool enabled);
+
+	// Counts the call and tells whether it has to be issued
+	static bool Changes(bool changed);
+private:
+	inline static u32 m_Program = 0;
+	inline static u32 m_Vao = 0;
+	inline static u32 m_Framebuffer = 0;
+
+	inline static u32 m_ActiveUnit = 0;
+	inline static u32 m_Textures[3][MaxTextureUnits] = {};
+
+	inline static glm::i32vec4 m_Viewport = glm::i32vec4(0);
+
+	inline static bool m_Blend = false;
+	inline static u32 m_BlendSource = 0;
+	inline static u32 m_BlendDestination = 0;
+	inline static bool m_DepthTest = false;
+	inline static u32 m_DepthFunc = 0;
+	inline static bool m_DepthMask = true;
+
+	inline static Stats m_Stats = {};
+	inline static Stats m_LastFrameStats = {};
+};
@@ -0,0 +1,88 @@
+#include <cstddef>
+#include <glad/glad.h>
+#include "GLState.h"
+#include "GeometryHeap.h"
+
+GeometryHeap::Allocation GeometryHeap::Allocate(const Vertex* vertices, const u32 vertexCount, const u32* indices, const u32 indexCount) {
+	CreateIfNeeded();
+
+	// Capacities double, so loading a scene only moves the buffers a handful of times
+	bool resized = false;
+	if (m_VertexCount + vertexCount > m_VertexCapacity) {
+		u32 capacity = m_VertexCapacity;
+		while (m_VertexCount + vertexCount > capacity) capacity *= 2;
+		m_Vbo = Grow(m_Vbo, sizeof(Vertex) * m_VertexCount, sizeof(Vertex) * capacity);
+		m_VertexCapacity = capacity;
+		resized = true;
+	}
+	if (m_IndexCount + indexCount > m_IndexCapacity) {
+		u32 capacity = m_IndexCapacity;
+		while (m_IndexCount + indexCount > capacity) capacity *= 2;
+		m_Ebo = Grow(m_Ebo, sizeof(u32) * m_IndexCount, sizeof(u32) * capacity);
+		m_IndexCapacity = capacity;
+		resized = true;
+	}
+	if (resized) {
+		SetupVertexArray();
+	}
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, m_Vbo);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, sizeof(Vertex) * m_VertexCount, sizeof(Vertex) * vertexCount, vertices);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, m_Ebo);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, sizeof(u32) * m_IndexCount, sizeof(u32) * indexCount, indices);
+
+	const Allocation allocation { m_IndexCount, static_cast<i32>(m_VertexCount) };
+	m_VertexCount += vertexCount;
+	m_IndexCount += indexCount;
+	return allocation;
+}
+
+u32 GeometryHeap::VertexArray() {
+	CreateIfNeeded();
+	return m_Vao;
+}
+
+void GeometryHeap::CreateIfNeeded() {
+	if (m_Vao != 0) return;
+
+	glGenBuffers(1, &m_Vbo);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, m_Vbo);
+	glBufferData(GL_COPY_WRITE_BUFFER, sizeof(Vertex) * m_VertexCapacity, nullptr, GL_STATIC_DRAW);
+
+	glGenBuffers(1, &m_Ebo);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, m_Ebo);
+	glBufferData(GL_COPY_WRITE_BUFFER, sizeof(u32) * m_IndexCapacity, nullptr, GL_STATIC_DRAW);
+
+	glGenVertexArrays(1, &m_Vao);
+	SetupVertexArray();
+}
+
+// Same layout as Mesh::GenOpenGLBuffers, so every shader works with heap and standalone meshes alike
+void GeometryHeap::SetupVertexArray() {
+	GLState::BindVertexArray(m_Vao);
+
+	glBindBuffer(GL_ARRAY_BUFFER, m_Vbo);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, position));
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, tangent));
+	glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, textureCoord));
+	glEnableVertexAttribArray(0);
+	glEnableVertexAttribArray(1);
+	glEnableVertexAttribArray(2);
+	glEnableVertexAttribArray(3);
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_Ebo);
+	GLState::BindVertexArray(0);
+}
+
+u32 GeometryHeap::Grow(const u32 buffer, const size_t usedBytes, const size_t newBytes) {
+	u32 grown;
+	glGenBuffers(1, &grown);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, grown);
+	glBufferData(GL_COPY_WRITE_BUFFER, newBytes, nullptr, GL_STATIC_DRAW);
+
+	glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+	glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, usedBytes);
+	glDeleteBuffers(1, &buffer);
+	return grown;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include "core/Base.h"
+#include "Vertex.h"
+
+// Vertex and index storage shared by every mesh that isn't modified after loading. All of them are drawn
+// through one VAO, so switching between them only changes the offsets of a draw command and consecutive
+// draws can be merged into a single glMultiDrawElementsIndirect.
+class GeometryHeap {
+public:
+	struct Allocation {
+		u32 firstIndex;
+		i32 baseVertex;
+	};
+
+	// Indices stay relative to the mesh's own vertices, draws add baseVertex to them
+	static Allocation Allocate(const Vertex* vertices, u32 vertexCount, const u32* indices, u32 indexCount);
+	static u32 VertexArray();
+private:
+	static void CreateIfNeeded();
+	static void SetupVertexArray();
+
+	// Moves the buffer's used bytes into a new buffer of the given size and returns it
+	static u32 Grow(u32 buffer, size_t usedBytes, size_t newBytes);
+private:
+	inline static u32 m_Vao = 0;
+	inline static u32 m_Vbo = 0;
+	inline static u32 m_Ebo = 0;
+
+	inline static u32 m_VertexCount = 0;
+	inline static u32 m_VertexCapacity = 1 << 16;
+	inline static u32 m_IndexCount = 0;
+	inline static u32 m_IndexCapacity = 1 << 18;
+};
@@ -0,0 +1,16 @@
+#include <glad/glad.h>
+#include "IndirectBuffer.h"
+
+void IndirectBuffer::Upload(const std::vector<DrawElementsIndirectCommand>& commands) {
+	if (m_Id == 0) {
+		glGenBuffers(1, &m_Id);
+	}
+
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_Id);
+	glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(DrawElementsIndirectCommand) * commands.size(), commands.data(), GL_STREAM_DRAW);
+}
+
+void IndirectBuffer::MultiDraw(const u32 firstCommand, const u32 count) {
+	const void* offset = (const void*)(sizeof(DrawElementsIndirectCommand) * firstCommand);
+	glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, offset, count, 0);
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <vector>
+#include "core/Base.h"
+
+// Layout glMultiDrawElementsIndirect reads its commands in
+struct DrawElementsIndirectCommand {
+	u32 count;
+	u32 instanceCount;
+	u32 firstIndex;
+	i32 baseVertex;
+	u32 baseInstance;
+};
+
+// Stream buffer bound as GL_DRAW_INDIRECT_BUFFER holding the commands of the pass being drawn
+class IndirectBuffer {
+public:
+	// Leaves the buffer bound, draws read their commands from byte offsets into it
+	static void Upload(const std::vector<DrawElementsIndirectCommand>& commands);
+
+	// glMultiDrawElementsIndirect of count commands starting at firstCommand
+	static void MultiDraw(u32 firstCommand, u32 count);
+private:
+	inline static u32 m_Id = 0;
+};
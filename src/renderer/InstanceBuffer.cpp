@@ -0,0 +1,42 @@
+#include <glad/glad.h>
+#include "FramePacket.h"
+#include "RenderQueue.h"
+#include "InstanceBuffer.h"
+
+void InstanceBuffer::Upload(const FramePacket& packet, const RenderQueue& queue) {
+	const std::vector<RenderQueue::Entry>& entries = queue.Entries();
+	const std::vector<DrawElementsIndirectCommand>& commands = queue.Commands();
+	m_Instances.resize(entries.size());
+
+	for (const DrawElementsIndirectCommand& command : commands) {
+		const u32 end = command.baseInstance + command.instanceCount;
+		for (u32 instance = command.baseInstance; instance < end; instance++) {
+			const DrawItem& item = *entries[instance].item;
+			m_Instances[instance] = Record(packet.WorldMatrix(item).matrix, packet.NormalMatrixOf(item).matrix, queue.MaterialIndexOf(instance));
+		}
+	}
+
+	Upload(m_Instances.data(), static_cast<u32>(m_Instances.size()));
+}
+
+// Respecifying the whole buffer lets the driver hand out fresh storage instead of waiting on draws that
+// still read the previous pass's instances
+void InstanceBuffer::Upload(const InstanceData* instances, const u32 count) {
+	if (m_Id == 0) {
+		glGenBuffers(1, &m_Id);
+	}
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_Id);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(InstanceData) * count, instances, GL_STREAM_DRAW);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, BindingPoint, m_Id);
+}
+
+InstanceData InstanceBuffer::Record(const AffineMatrix& model, const glm::mat3& normalMatrix, const u32 materialIndex) {
+	InstanceData record {};
+	record.model = model;
+	for (i32 column = 0; column < 3; column++) {
+		record.normalMatrix[column] = glm::vec4(normalMatrix[column], 0.0f);
+	}
+	record.materialIndex = materialIndex;
+	return record;
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <vector>
+#include <glm/glm.hpp>
+#include "core/AffineMatrix.h"
+#include "core/Base.h"
+
+struct FramePacket;
+class RenderQueue;
+
+// Per instance record, laid out like the std430 Instance struct the shaders declare
+struct InstanceData {
+	AffineMatrix model;
+	// Columns of the normal matrix, std430 pads every mat3 column to a vec4
+	glm::vec4 normalMatrix[3];
+	u32 materialIndex;
+	u32 padding[3];
+};
+static_assert(sizeof(InstanceData) == 112, "InstanceData must match the std430 layout of Instance");
+
+// Shader storage buffer at binding 2 holding a record for every instance of the pass being drawn. Shaders
+// read theirs at gl_BaseInstance + gl_InstanceID, so consecutive draws only differ in their base instance.
+class InstanceBuffer {
+public:
+	static constexpr u32 BindingPoint = 2;
+
+	// Record i belongs to the queue's entry i, with the index of that entry's material in the MaterialBuffer
+	static void Upload(const FramePacket& packet, const RenderQueue& queue);
+	static void Upload(const InstanceData* instances, u32 count);
+
+	static InstanceData Record(const AffineMatrix& model, const glm::mat3& normalMatrix, u32 materialIndex);
+private:
+	inline static u32 m_Id = 0;
+	inline static std::vector<InstanceData> m_Instances;
+};
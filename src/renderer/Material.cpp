@@ -1,6 +1,4 @@
 #include <glad/glad.h>
-#include "renderer/ShadowMapper.h"
-#include "renderer/Enviroment.h"
 #include "Material.h"
 
 #include "Renderer.h"
@@ -9,43 +7,37 @@ Material::Material(Shader shader)
 	: m_Shader(std::move(shader)), m_RenderOrder(RenderOrder::opaque), m_AlphaCutoff(0.0f),
 	m_Metallicness(0.5f), m_Roughness(0.5f), m_Specularity(1.0f), m_Tiling(1.0f, 1.0f) { }
 
-void Material::Bind(const LocalToWorld& toWorld) {
+void Material::BindShader() const {
 	m_Shader.Bind();
-	m_Shader.SetMat4("model", toWorld.matrix);
-
-	BindTextureIfExists("albedoMap", m_AlbedoTexture, 0);
-	BindTextureIfExists("normalMap", m_NormalTexture, 1);
-	BindTextureIfExists("metallicRoughnessMap", m_MetalRoughTexture, 2);
+}
 
-	bool alphaClippingEnabled = m_RenderOrder == RenderOrder::cutout || m_AlphaCutoff > 0.5f;
-	m_Shader.SetInt("alphaClippingEnabled", alphaClippingEnabled);
-	if (alphaClippingEnabled) {
-		m_Shader.SetFloat("alphaCutoff", m_AlphaCutoff);
+void Material::BindTextures() const {
+	const Ref<Texture> textures[] = { m_AlbedoTexture, m_NormalTexture, m_MetalRoughTexture };
+	for (u32 unit = 0; unit < 3; unit++) {
+		if (textures[unit] != nullptr) {
+			textures[unit]->Bind(unit);
+		}
 	}
+}
 
-	m_Shader.SetFloat("roughness", m_Roughness);
-	m_Shader.SetFloat("specularStrength", m_Specularity);
-	m_Shader.SetFloat("metallic", m_Metallicness);
-	m_Shader.SetVec2("tiling", m_Tiling);
-	
-	ShadowMapper::BindShadowMap(3);
-	m_Shader.SetInt("shadowMap", 3);
-
-	Enviroment::Instance()->BindSkybox(4);
-	m_Shader.SetInt("skybox", 4);
-
-	Enviroment::Instance()->BindPcfShadow(5);
-	m_Shader.SetInt("shadowPcfMap", 5);
+bool Material::SharesTexturesWith(const Material& other) const {
+	return m_AlbedoTexture == other.m_AlbedoTexture && m_NormalTexture == other.m_NormalTexture &&
+		m_MetalRoughTexture == other.m_MetalRoughTexture;
 }
 
-void Material::BindTextureIfExists(const std::string& uniformName, const Ref<Texture> texture, const u32 textureUnit) {
-	bool useTexture = texture != nullptr;
-	m_Shader.SetInt(uniformName + "Enabled", useTexture);
-	if (useTexture) {
-		glActiveTexture(GL_TEXTURE0 + textureUnit);
-		texture->Bind();
-		m_Shader.SetInt(uniformName, textureUnit);
-	}
+MaterialData Material::Record() const {
+	MaterialData record {};
+	record.tiling = m_Tiling;
+	record.roughness = m_Roughness;
+	record.metallic = m_Metallicness;
+	record.specularStrength = m_Specularity;
+	record.alphaCutoff = m_AlphaCutoff;
+
+	if (m_AlbedoTexture != nullptr) record.flags |= MaterialData::AlbedoMap;
+	if (m_NormalTexture != nullptr) record.flags |= MaterialData::NormalMap;
+	if (m_MetalRoughTexture != nullptr) record.flags |= MaterialData::MetallicRoughnessMap;
+	if (m_RenderOrder == RenderOrder::cutout || m_AlphaCutoff > 0.5f) record.flags |= MaterialData::AlphaClipping;
+	return record;
 }
 
 Material* Material::NewPbrMaterial() {
@@ -3,6 +3,7 @@
 #include <bitset>
 #include "Texture.h"
 #include "renderer/Shader.h"
+#include "renderer/MaterialBuffer.h"
 #include "core/Components.h"
 
 enum class RenderOrder {
@@ -34,6 +35,8 @@ public:
 	f32 GetMetallicness() const        { return m_Metallicness; }
 	f32 GetSpecularity() const         { return m_Specularity; }
 	glm::vec2 GetTiling() const        { return m_Tiling; }
+	u32 GetShaderId() const            { return m_Shader.Id(); }
+	u32 GetId() const                  { return m_Id; }
 	
 	std::string GetAlbedoPath() const     { return m_AlbedoTexture != nullptr ? m_AlbedoTexture->Path() : ""; }
 	std::string GetNormalPath() const     { return m_NormalTexture != nullptr ? m_NormalTexture->Path() : ""; }
@@ -42,13 +45,22 @@ public:
 	void SetFilePath(const std::string& filePath) { m_FilePath = filePath; }
 	std::string GetFilePath() const { return m_FilePath; }
 	
-	void Bind(const LocalToWorld& toWorld);
-private:
-	void BindTextureIfExists(const std::string& uniformName, const Ref<Texture> texture, u32 textureUnit);
+	// Split so a run of draws sharing a shader only binds it once. Constants reach the shader through the
+	// MaterialBuffer, so only the material's own textures are bound per material, to units 0-2.
+	void BindShader() const;
+	void BindTextures() const;
+	MaterialData Record() const;
+
+	// True when BindTextures of both binds the same textures, so their draws can share a batch
+	bool SharesTexturesWith(const Material& other) const;
 private:
 	// Needed by the editor to save changes when modified
 	std::string m_FilePath;
 
+	// Small unique number for render queue sort keys
+	const u32 m_Id = s_MaterialCounter++;
+	inline static u32 s_MaterialCounter = 0;
+
 	Ref<Texture> m_AlbedoTexture;
 	Ref<Texture> m_NormalTexture;
 	Ref<Texture> m_MetalRoughTexture;
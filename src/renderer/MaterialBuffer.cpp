@@ -0,0 +1,18 @@
+#include <glad/glad.h>
+#include "Material.h"
+#include "MaterialBuffer.h"
+
+void MaterialBuffer::Upload(const std::vector<const Material*>& materials) {
+	if (m_Id == 0) {
+		glGenBuffers(1, &m_Id);
+	}
+
+	m_Records.clear();
+	for (const Material* material : materials) {
+		m_Records.push_back(material->Record());
+	}
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_Id);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(MaterialData) * m_Records.size(), m_Records.data(), GL_STREAM_DRAW);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, BindingPoint, m_Id);
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <vector>
+#include <glm/glm.hpp>
+#include "core/Base.h"
+
+class Material;
+
+// Material constants, laid out like the std430 MaterialRecord struct in PBR.frag
+struct MaterialData {
+	enum Flags : u32 {
+		AlbedoMap = 1 << 0,
+		NormalMap = 1 << 1,
+		MetallicRoughnessMap = 1 << 2,
+		AlphaClipping = 1 << 3,
+	};
+
+	glm::vec2 tiling;
+	f32 roughness;
+	f32 metallic;
+	f32 specularStrength;
+	f32 alphaCutoff;
+	u32 flags;
+	u32 padding;
+};
+static_assert(sizeof(MaterialData) == 32, "MaterialData must match the std430 layout of MaterialRecord");
+
+// Shader storage buffer at binding 3 with the constants of every material drawn in the scene pass,
+// found through the materialIndex of each instance record. Replaces the per draw glUniform calls.
+class MaterialBuffer {
+public:
+	static constexpr u32 BindingPoint = 3;
+
+	// Record i belongs to materials[i]
+	static void Upload(const std::vector<const Material*>& materials);
+private:
+	inline static u32 m_Id = 0;
+	inline static std::vector<MaterialData> m_Records;
+};
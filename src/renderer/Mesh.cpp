@@ -1,6 +1,8 @@
 #include <glad/glad.h>
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
+#include "GeometryHeap.h"
+#include "GLState.h"
 #include "Mesh.h"
 
 Mesh Mesh::FromFile(const char* meshPath) {
@@ -49,13 +51,16 @@ Mesh Mesh::FromAssimpMesh(const aiMesh* meshData) {
 		}
 	}
 
-	mesh.GenOpenGLBuffers();
+	mesh.AllocateInGeometryHeap();
 	return mesh;
 }
 
 void Mesh::GenOpenGLBuffers() {
+	CalculateBounds();
+	m_Id = s_MeshCounter++;
+
 	glGenVertexArrays(1, &m_Vao);
-	glBindVertexArray(m_Vao);
+	GLState::BindVertexArray(m_Vao);
 
 	glGenBuffers(1, &m_Vbo);
 	glBindBuffer(GL_ARRAY_BUFFER, m_Vbo);
@@ -75,8 +80,25 @@ void Mesh::GenOpenGLBuffers() {
 	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(u32) * m_NumIndices, &m_Indices[0], GL_STATIC_DRAW);
 }
 
+void Mesh::AllocateInGeometryHeap() {
+	CalculateBounds();
+	m_Id = s_MeshCounter++;
+
+	const GeometryHeap::Allocation allocation = GeometryHeap::Allocate(&m_Verts[0], m_NumVerts, &m_Indices[0], m_NumIndices);
+	m_Vao = GeometryHeap::VertexArray();
+	m_FirstIndex = allocation.firstIndex;
+	m_BaseVertex = allocation.baseVertex;
+}
+
+void Mesh::CalculateBounds() {
+	m_Bounds = Bounds(&m_Verts[0].position, 1);
+	for (u32 i = 1; i < m_NumVerts; i++) {
+		m_Bounds.Encapsulate(m_Verts[i].position);
+	}
+}
+
 void Mesh::UpdateVertexBuffer() const {
-	glBindVertexArray(m_Vao);
+	ASSERT(m_Vbo != 0, "Meshes in the geometry heap can't be updated");
+	glBindBuffer(GL_ARRAY_BUFFER, m_Vbo);
 	glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * m_NumVerts, &m_Verts[0], GL_STATIC_DRAW);
-	glBindVertexArray(0);
 }
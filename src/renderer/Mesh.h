@@ -2,22 +2,41 @@
 #include <assimp/scene.h>
 #include "core/Base.h"
 #include "Vertex.h"
+#include "Bounds.h"
 
 class Mesh {
 public:
 	static Mesh FromAssimpMesh(const aiMesh* meshData);
 	static Mesh FromFile(const char* meshPath);
 
+	// Gives the mesh its own buffers and VAO, for meshes whose vertices are updated later
 	void GenOpenGLBuffers();
+	// Places the mesh in the shared GeometryHeap, for meshes that never change after loading
+	void AllocateInGeometryHeap();
 	void UpdateVertexBuffer() const;
+private:
+	void CalculateBounds();
 public:
 	u32 m_Vao;
-	u32 m_Vbo;
-	u32 m_Ebo;
+	u32 m_Vbo = 0;
+	u32 m_Ebo = 0;
+
+	// Where the mesh starts in its index and vertex buffers, only non zero for heap meshes
+	u32 m_FirstIndex = 0;
+	i32 m_BaseVertex = 0;
 
 	u32 m_NumIndices;
 	u32 m_NumVerts;
 
+	// Shared by copies of the mesh, which use the same GL storage
+	u32 m_Id = 0;
+
+	// Local space bounds of the vertices, computed when the buffers are generated
+	Bounds m_Bounds;
+
 	Ref<Vertex[]> m_Verts;
 	Ref<u32[]> m_Indices;
+private:
+	// Starts at one so a mesh that was never uploaded is easy to spot
+	inline static u32 s_MeshCounter = 1;
 };
\ No newline at end of file
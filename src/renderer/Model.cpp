@@ -5,26 +5,28 @@
 #include "core/Serializer.h"
 #include "Model.h"
 
-Entity Model::Instantiate(const char* importedModelFile, Registry& registry) {
+Entity Model::Instantiate(const char* importedModelFile, Registry& registry, const bool isStatic) {
 	std::vector<YAML::Node> nodes = YAML::LoadAllFromFile(importedModelFile);
 
 	YAML::Node& header = nodes.front();
 	const auto& modelFile = header["SourceFile"].as<std::string>();
 
+	// The source file is only imported when one of its meshes hasn't been loaded yet
 	Assimp::Importer importer;
-	const aiScene* scene = importer.ReadFile(modelFile, aiProcess_Triangulate | aiProcess_CalcTangentSpace);
-
-	assert(scene || !(scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE) || scene->mRootNode);
+	const aiScene* scene = nullptr;
+	std::unordered_map<i32, Mesh>& loadedMeshes = m_LoadedMeshes[modelFile];
 
 	Entity rootEntity = Entity::Null();
 
-	std::vector<Entity> entityLookUp;
+	// The first node is the header, every other node becomes an entity
+	const size_t entityCount = nodes.size() - 1;
+	registry.Reserve<LocalToWorld, Transform>(registry.GetEntityCount() + entityCount);
+	std::vector<Entity> entityLookUp = registry.CreateMany(entityCount);
 
 	for (size_t i = 1; i < nodes.size(); i++) {
 		YAML::Node node = nodes[i];
 
-		Entity entity = registry.Create();
-		entityLookUp.push_back(entity);
+		Entity entity = entityLookUp[i - 1];
 		registry.Add<LocalToWorld>(entity);
 
 		YAML::Node components = node["Components"];
@@ -33,6 +35,10 @@ Entity Model::Instantiate(const char* importedModelFile, Registry& registry) {
 		auto& trans = registry.Add<Transform>(entity);
 		Serializer::Deserialize(transNode, trans);
 
+		if (isStatic) {
+			registry.Add<Static>(entity);
+		}
+
 		if (YAML::Node parentNode = node["ParentId"]; !parentNode.IsNull()) {
 			i32 parentIndex = parentNode.as<i32>();
 			Entity parentEntity = entityLookUp[parentIndex];
@@ -51,15 +57,26 @@ Entity Model::Instantiate(const char* importedModelFile, Registry& registry) {
 
 		const auto& meshIndicies = meshIndicesNode.as<std::vector<i32>>();
 		for (const i32 meshIndex : meshIndicies) {
-			meshRenderer.meshes.push_back(Mesh::FromAssimpMesh(scene->mMeshes[meshIndex]));
+			auto loadedMesh = loadedMeshes.find(meshIndex);
+			if (loadedMesh == loadedMeshes.end()) {
+				if (!scene) {
+					scene = importer.ReadFile(modelFile, aiProcess_Triangulate | aiProcess_CalcTangentSpace);
+					assert(scene || !(scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE) || scene->mRootNode);
+				}
+				loadedMesh = loadedMeshes.emplace(meshIndex, Mesh::FromAssimpMesh(scene->mMeshes[meshIndex])).first;
+			}
+			meshRenderer.meshes.push_back(loadedMesh->second);
 		}
 
 		const auto& materialFiles = materialsNode.as<std::vector<std::string>>();
 		for (const std::string& materialFile : materialFiles) {
-			ASSERT(std::filesystem::exists(materialFile), materialFile);
-			Material* standardMaterial = Material::NewPbrMaterial();
-			Serializer::Deserialize(materialFile, *standardMaterial);
-			meshRenderer.materials.push_back(standardMaterial);
+			Material*& material = m_LoadedMaterials[materialFile];
+			if (!material) {
+				ASSERT(std::filesystem::exists(materialFile), materialFile);
+				material = Material::NewPbrMaterial();
+				Serializer::Deserialize(materialFile, *material);
+			}
+			meshRenderer.materials.push_back(material);
 		}
 
 		if (rootEntity == Entity::Null()) {
@@ -1,4 +1,6 @@
 #pragma once
+#include <string>
+#include <unordered_map>
 #include "Mesh.h"
 #include "Material.h"
 #include "ecs/Registry.h"
@@ -6,5 +8,13 @@
 
 class Model {
 public:
-	static Entity Instantiate(const char* importedModelFile, Registry& registry);
+	// Static models get the Static tag on every entity, so they can't be moved afterwards
+	static Entity Instantiate(const char* importedModelFile, Registry& registry, bool isStatic = false);
+private:
+	// Meshes by source file and mesh index. Entities using the same mesh share its GeometryHeap range and
+	// mesh id, so draws of them can be instanced.
+	inline static std::unordered_map<std::string, std::unordered_map<i32, Mesh>> m_LoadedMeshes;
+
+	// Materials by material file, shared by every entity that lists the file
+	inline static std::unordered_map<std::string, Material*> m_LoadedMaterials;
 };
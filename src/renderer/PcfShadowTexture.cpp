@@ -1,5 +1,6 @@
 ﻿#include <vector>
 #include <glad/glad.h>
+#include "GLState.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/random.hpp>
 #include <glm/ext/scalar_constants.hpp>
@@ -11,7 +12,7 @@ PcfShadowTexture::PcfShadowTexture(const i32 windowSize, const i32 filterSize)
     std::vector<glm::vec2> texels = CreateTexels();
 
     glGenTextures(1, &m_Id);
-    glBindTexture(GL_TEXTURE_3D, m_Id);
+    GLState::BindTexture(GL_TEXTURE_3D, m_Id);
     
     glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -20,16 +21,16 @@ PcfShadowTexture::PcfShadowTexture(const i32 windowSize, const i32 filterSize)
 
     i32 filterSqr = m_FilterSize * m_FilterSize;
     glTexImage3D(GL_TEXTURE_3D, 0, GL_RG32F, filterSqr, m_WindowSize, m_WindowSize, 0, GL_RG, GL_FLOAT, texels.data());
-    glBindTexture(GL_TEXTURE_3D, 0);
+    GLState::BindTexture(GL_TEXTURE_3D, 0);
 }
 
 PcfShadowTexture::~PcfShadowTexture() {
    glDeleteTextures(1, &m_Id); 
+   GLState::OnTextureDeleted(m_Id);
 }
 
 void PcfShadowTexture::Bind(const i32 textureUnit) const {
-    glActiveTexture(GL_TEXTURE0 + textureUnit);
-    glBindTexture(GL_TEXTURE_3D, m_Id);
+    GLState::BindTexture(textureUnit, GL_TEXTURE_3D, m_Id);
 }
 
 std::vector<glm::vec2> PcfShadowTexture::CreateTexels() const {
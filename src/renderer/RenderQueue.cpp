@@ -0,0 +1,133 @@
+#include <bit>
+#include <cstring>
+#include "RenderQueue.h"
+
+namespace {
+	constexpr u32 DepthBits = 20;
+	constexpr u32 ShaderBits = 10;
+	constexpr u32 MaterialBits = 16;
+	constexpr u32 MeshBits = 16;
+
+	// Ids wider than their field wrap around, which only costs sorting quality, never correctness
+	u64 Field(const u64 value, const u32 bits) {
+		return value & ((1ull << bits) - 1);
+	}
+}
+
+void RenderQueue::Push(const DrawItem& item, const glm::vec3& cameraPosition, const glm::vec3& cameraForward) {
+	const Material& material = *item.material;
+	const RenderOrder pass = material.GetRenderOrder();
+	const u64 depth = QuantizeDepth(glm::dot(item.bounds.Center() - cameraPosition, cameraForward));
+
+	const u64 shader = Field(material.GetShaderId(), ShaderBits);
+	const u64 materialId = Field(material.GetId(), MaterialBits);
+	const u64 mesh = Field(item.mesh, MeshBits);
+
+	u64 key = static_cast<u64>(pass) << 62;
+	if (pass == RenderOrder::transparent) {
+		const u64 invertedDepth = Field(~depth, DepthBits);
+		key |= invertedDepth << (ShaderBits + MaterialBits + MeshBits);
+		key |= shader << (MaterialBits + MeshBits);
+		key |= materialId << MeshBits;
+		key |= mesh;
+	} else {
+		key |= shader << (MaterialBits + MeshBits + DepthBits);
+		key |= materialId << (MeshBits + DepthBits);
+		key |= mesh << DepthBits;
+		key |= depth;
+	}
+
+	m_Entries.push_back({ key, &item });
+}
+
+void RenderQueue::PushMeshOnly(const DrawItem& item) {
+	m_Entries.push_back({ static_cast<u64>(item.vao) << 32 | item.mesh, &item });
+}
+
+void RenderQueue::Clear() {
+	m_Entries.clear();
+	m_Commands.clear();
+	m_Batches.clear();
+	m_Materials.clear();
+}
+
+void RenderQueue::BuildBatches(const bool sameMaterial) {
+	m_Commands.clear();
+	m_Batches.clear();
+	m_Materials.clear();
+	m_MaterialIndices.clear();
+
+	const DrawItem* previous = nullptr;
+	u64 previousKey = 0;
+	for (u32 i = 0; i < m_Entries.size(); i++) {
+		const DrawItem& item = *m_Entries[i].item;
+		const u64 key = m_Entries[i].key;
+
+		if (sameMaterial) {
+			if (m_Materials.empty() || m_Materials.back() != item.material) {
+				m_Materials.push_back(item.material);
+			}
+			m_MaterialIndices.push_back(static_cast<u32>(m_Materials.size()) - 1);
+		}
+
+		const bool stateChanged = sameMaterial && previous && (PassOf(key) != PassOf(previousKey) ||
+			item.material->GetShaderId() != previous->material->GetShaderId() ||
+			!item.material->SharesTexturesWith(*previous->material));
+
+		previousKey = key;
+		if (previous && item.mesh == previous->mesh && !stateChanged) {
+			m_Commands.back().instanceCount++;
+			continue;
+		}
+
+		if (!previous || item.vao != previous->vao || stateChanged) {
+			m_Batches.push_back({ &item, key, static_cast<u32>(m_Commands.size()), 0 });
+		}
+
+		m_Commands.push_back({ item.indexCount, 1, item.firstIndex, item.baseVertex, i });
+		m_Batches.back().commandCount++;
+		previous = &item;
+	}
+}
+
+void RenderQueue::Sort() {
+	const size_t count = m_Entries.size();
+	if (count <= 1) return;
+
+	m_Scratch.resize(count);
+	Entry* source = m_Entries.data();
+	Entry* destination = m_Scratch.data();
+
+	for (u32 shift = 0; shift < 64; shift += 8) {
+		size_t offsets[256] = {};
+		for (size_t i = 0; i < count; i++) {
+			offsets[(source[i].key >> shift) & 0xFF]++;
+		}
+
+		// All keys share this byte, the pass wouldn't move anything
+		if (offsets[(source[0].key >> shift) & 0xFF] == count) continue;
+
+		size_t total = 0;
+		for (size_t& offset : offsets) {
+			const size_t bucketSize = offset;
+			offset = total;
+			total += bucketSize;
+		}
+
+		for (size_t i = 0; i < count; i++) {
+			destination[offsets[(source[i].key >> shift) & 0xFF]++] = source[i];
+		}
+		std::swap(source, destination);
+	}
+
+	if (source != m_Entries.data()) {
+		std::memcpy(m_Entries.data(), source, count * sizeof(Entry));
+	}
+}
+
+u64 RenderQueue::QuantizeDepth(const f32 depth) {
+	// Items behind the camera are culled by the GPU anyway, they all share the nearest bucket
+	const f32 clamped = depth > 0.0f ? depth : 0.0f;
+	// The sign bit is always clear, shifting it out keeps one more bit of precision
+	return (std::bit_cast<u32>(clamped) << 1) >> (32 - DepthBits);
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <vector>
+#include <glm/glm.hpp>
+#include "core/Base.h"
+#include "FramePacket.h"
+#include "IndirectBuffer.h"
+#include "Material.h"
+
+// Draw items tagged with a 64 bit key and sorted by it, so submitting them in order changes as little
+// GL state as possible. From the most significant bit down the keys hold:
+//   opaque and cutout: pass (2) | shader (10) | material (16) | mesh (16) | depth (20)
+//   transparent:       pass (2) | inverted depth (20) | shader (10) | material (16) | mesh (16)
+// Opaque items with the same state are drawn front to back to help early depth testing, transparent
+// items are drawn back to front regardless of state so they blend correctly.
+class RenderQueue {
+public:
+	struct Entry {
+		u64 key;
+		const DrawItem* item;
+	};
+
+	// Commands drawn with one glMultiDrawElementsIndirect, they all use the VAO and, when built with
+	// sameMaterial, the pass, shader and textures of the first item
+	struct Batch {
+		const DrawItem* item;
+		u64 key;
+		u32 firstCommand;
+		u32 commandCount;
+	};
+
+	void Clear();
+
+	// Depth is the distance of the item's bounds center along the camera's forward axis. The item must
+	// outlive the queue's use.
+	void Push(const DrawItem& item, const glm::vec3& cameraPosition, const glm::vec3& cameraForward);
+
+	// Key of only the VAO and mesh, for depth only passes where neither materials nor draw order matter
+	void PushMeshOnly(const DrawItem& item);
+
+	// Stable LSD radix sort, one byte per pass. Passes where every key has the same byte are skipped.
+	void Sort();
+
+	// Turns the sorted entries into one indirect command per run of entries sharing a mesh. A command's
+	// instances are the entries at the same positions of the InstanceBuffer. Consecutive commands that can
+	// be drawn together are grouped into batches. With sameMaterial, commands and batches are also split
+	// wherever the pass, shader or bound textures change. Material constants are read per instance from the
+	// MaterialBuffer, so materials that only differ in constants still share commands.
+	void BuildBatches(bool sameMaterial);
+
+	const std::vector<Entry>& Entries() const { return m_Entries; }
+	const std::vector<DrawElementsIndirectCommand>& Commands() const { return m_Commands; }
+	const std::vector<Batch>& Batches() const { return m_Batches; }
+
+	// One entry per run of entries sharing a material, in the order of the MaterialBuffer's records
+	const std::vector<const Material*>& Materials() const { return m_Materials; }
+
+	// Record of the entry's material in Materials(), zero when built without sameMaterial
+	u32 MaterialIndexOf(const u32 entry) const { return m_MaterialIndices.empty() ? 0 : m_MaterialIndices[entry]; }
+
+	static RenderOrder PassOf(const u64 key) { return static_cast<RenderOrder>(key >> 62); }
+private:
+	// Top bits of the float's pattern, which orders like the float itself for positive values
+	static u64 QuantizeDepth(f32 depth);
+private:
+	std::vector<Entry> m_Entries;
+	std::vector<Entry> m_Scratch;
+	std::vector<DrawElementsIndirectCommand> m_Commands;
+	std::vector<Batch> m_Batches;
+	std::vector<const Material*> m_Materials;
+	std::vector<u32> m_MaterialIndices;
+};
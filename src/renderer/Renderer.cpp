@@ -5,15 +5,19 @@
 #include "ShadowMapper.h"
 #include "core/CameraSystem.h"
 #include "ecs/Registry.h"
-#include "ecs/View.h"
+#include "ecs/Group.h"
+#include "GLState.h"
+#include "IndirectBuffer.h"
+#include "InstanceBuffer.h"
+#include "MaterialBuffer.h"
 #include "Renderer.h"
 
 void Renderer::Init() {
 	glEnable(GL_FRAMEBUFFER_SRGB);
 	glEnable(GL_MULTISAMPLE);
 	glEnable(GL_CULL_FACE);
-	glEnable(GL_DEPTH_TEST);
-	glDepthFunc(GL_LESS);
+	GLState::SetDepthTest(true);
+	GLState::DepthFunc(GL_LESS);
 
 	i32 hardwareTextureUnitCount;
 	glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &hardwareTextureUnitCount);
@@ -26,51 +30,150 @@ void Renderer::Init() {
 	m_PostProcessingParams = { 0.07f, 0.1f, 0.0f };
 }
 
-void Renderer::RenderScene(Registry& registry) {
+void Renderer::RenderScene() {
 	DrawSkybox();
-	
-	const auto view = View<LocalToWorld, Transform, MeshRenderer>(registry);
 
-    for (const auto entity : view) {
-        auto& toWorld = registry.Get<LocalToWorld>(entity);
-        const auto& meshRenderer = registry.Get<MeshRenderer>(entity);
+	const FramePacket& packet = CurrentFramePacket();
+	const glm::vec3 cameraPosition = CameraSystem::ActiveCamPos();
+	const glm::vec3 cameraForward = CameraSystem::ActiveCamForward();
+
+	m_RenderQueue.Clear();
+	packet.ForEachItem([cameraPosition, cameraForward](const DrawItem& item) {
+		m_RenderQueue.Push(item, cameraPosition, cameraForward);
+	});
+	m_RenderQueue.Sort();
+	m_RenderQueue.BuildBatches(true);
+
+	MaterialBuffer::Upload(m_RenderQueue.Materials());
+	InstanceBuffer::Upload(packet, m_RenderQueue);
+	IndirectBuffer::Upload(m_RenderQueue.Commands());
+
+	// The same for every material, units 3-5 match the bindings in PBR.frag
+	ShadowMapper::BindShadowMap(3);
+	Enviroment::Instance()->BindSkybox(4);
+	Enviroment::Instance()->BindPcfShadow(5);
+
+	m_Stats = {};
+	m_Stats.commands = static_cast<u32>(m_RenderQueue.Commands().size());
+	m_Stats.instances = static_cast<u32>(m_RenderQueue.Entries().size());
+
+	u32 boundShader = 0;
+	const Material* boundTextures = nullptr;
+	u32 boundVao = 0;
+	bool blending = false;
+
+	for (const RenderQueue::Batch& batch : m_RenderQueue.Batches()) {
+		const DrawItem& item = *batch.item;
+
+		// Cutout items are blended like before the queue so their alpha tested edges stay soft. They and the
+		// transparent items are sorted after every opaque item, so blending stays on until the end of the queue.
+		if (!blending && RenderQueue::PassOf(batch.key) != RenderOrder::opaque) {
+			GLState::SetBlend(true);
+			GLState::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+			blending = true;
+		}
 
-		for (u32 i = 0; i < meshRenderer.meshes.size(); i++) {
-			assert(meshRenderer.materials[i]);
-			Material* mat = meshRenderer.materials[i];
+		if (item.material->GetShaderId() != boundShader) {
+			item.material->BindShader();
+			boundShader = item.material->GetShaderId();
+			m_Stats.shaderBinds++;
+		}
 
-			if (mat->GetRenderOrder() == RenderOrder::transparent) continue;
+		// Batches of materials that only differ in constants keep the textures bound
+		if (!boundTextures || !item.material->SharesTexturesWith(*boundTextures)) {
+			item.material->BindTextures();
+			boundTextures = item.material;
+			m_Stats.materialBinds++;
+		}
 
-			mat->Bind(toWorld);
-			DrawMesh(meshRenderer.meshes[i]);
+		if (item.vao != boundVao) {
+			GLState::BindVertexArray(item.vao);
+			boundVao = item.vao;
+			m_Stats.vaoBinds++;
 		}
-    }
 
-	// Draw transparent objects
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		IndirectBuffer::MultiDraw(batch.firstCommand, batch.commandCount);
+		m_Stats.drawCalls++;
+	}
+
+	GLState::SetBlend(false);
+}
+
+void Renderer::NewFrame(Registry& registry) {
+	GLState::NewFrame();
+	ExtractScene(registry);
+	ShadowMapper::PerformShadowPass(CurrentFramePacket());
+	m_HdrFrameBuffer.BindAndClear();
+}
 
-    for (const auto entity : view) {
-        auto& toWorld = registry.Get<LocalToWorld>(entity);
-        const auto& meshRenderer = registry.Get<MeshRenderer>(entity);
+void Renderer::ExtractScene(Registry& registry) {
+	const u32 backPacket = 1 - m_CurrentPacket;
+	FramePacket& packet = m_FramePackets[backPacket];
+	packet.Clear();
 
-		for (u32 i = 0; i < meshRenderer.meshes.size(); i++) {
-			assert(meshRenderer.materials[i]);
-			Material* mat = meshRenderer.materials[i];
+	// After a structural change iterating the static group repacks archetype registries first, so every
+	// index gathered below is still valid when the pools are copied
+	if (registry.GetId() != m_StaticRegistryId || registry.GetStructureChangeCount() != m_StaticStructureChanges) {
+		ExtractStaticItems(registry);
+	}
 
-			if (mat->GetRenderOrder() == RenderOrder::opaque) continue;
+	if (packet.staticItemsVersion != m_StaticItemsVersion) {
+		packet.staticItems = m_StaticItems;
+		packet.staticItemsVersion = m_StaticItemsVersion;
+	}
 
-			mat->Bind(toWorld);
-			DrawMesh(meshRenderer.meshes[i]);
-		}
-    }
+	// Only handles and matrix indices are gathered per entity, MeshRenderer itself is never copied
+	auto& group = registry.GetGroup<LocalToWorld, NormalMatrix, Transform, MeshRenderer>(Exclude<Static>());
+	group.Each<MeshRenderer>([&registry, &packet](Entity entity, const MeshRenderer& meshRenderer) {
+		PushDrawItems(registry, entity, meshRenderer, packet.items);
+	});
 
-	glDisable(GL_BLEND);
+	// Nothing changes structurally between gathering the indices and the copy, so they stay valid
+	registry.CopyComponents(packet.worldMatrices);
+	registry.CopyComponents(packet.normalMatrices);
+
+	for (DrawItem& item : packet.items) {
+		item.bounds = item.bounds.Transformed(packet.WorldMatrix(item).matrix);
+	}
+
+	m_CurrentPacket = backPacket;
 }
 
-void Renderer::NewFrame(Registry& registry) {
-	ShadowMapper::PerformShadowPass(registry);
-	m_HdrFrameBuffer.BindAndClear();
+// Static entities only change together with the registry's structure, so their items and world bounds are
+// gathered here once instead of every frame. Their matrices were baked by the TransformSystem already.
+void Renderer::ExtractStaticItems(Registry& registry) {
+	m_StaticItems.clear();
+
+	auto& group = registry.GetGroup<LocalToWorld, NormalMatrix, Transform, MeshRenderer, Static>();
+	group.Each<MeshRenderer>([&registry](Entity entity, const MeshRenderer& meshRenderer) {
+		PushDrawItems(registry, entity, meshRenderer, m_StaticItems);
+	});
+
+	ComponentPool* toWorlds = registry.GetPool<LocalToWorld>();
+	for (DrawItem& item : m_StaticItems) {
+		const auto& toWorld = *static_cast<const LocalToWorld*>(toWorlds->GetDenseAddress(item.matrixIndex));
+		item.bounds = item.bounds.Transformed(toWorld.matrix);
+	}
+
+	// Read only, the render system must not advance the registry's version
+	m_StaticStructureChanges = registry.GetStructureChangeCount();
+	m_StaticRegistryId = registry.GetId();
+	m_StaticItemsVersion++;
+}
+
+void Renderer::PushDrawItems(Registry& registry, const Entity entity, const MeshRenderer& meshRenderer, std::vector<DrawItem>& items) {
+	const u32 matrixIndex = registry.DenseIndexOf<LocalToWorld>(entity);
+	const u32 normalIndex = registry.DenseIndexOf<NormalMatrix>(entity);
+
+	for (u32 i = 0; i < meshRenderer.meshes.size(); i++) {
+		assert(meshRenderer.materials[i]);
+		const Mesh& mesh = meshRenderer.meshes[i];
+		items.push_back({
+			matrixIndex, normalIndex,
+			mesh.m_Vao, mesh.m_Id, mesh.m_FirstIndex, mesh.m_BaseVertex, mesh.m_NumIndices,
+			meshRenderer.materials[i], mesh.m_Bounds
+		});
+	}
 }
 
 void Renderer::EndFrame() {
@@ -116,8 +219,8 @@ void Renderer::ResizeFrameBuffer(const glm::i32vec2& size) {
 }
 
 void Renderer::DrawMesh(const Mesh& mesh) {
-	glBindVertexArray(mesh.m_Vao);
-	glDrawElements(GL_TRIANGLES, mesh.m_NumIndices, GL_UNSIGNED_INT, nullptr);
+	GLState::BindVertexArray(mesh.m_Vao);
+	glDrawElementsBaseVertex(GL_TRIANGLES, mesh.m_NumIndices, GL_UNSIGNED_INT, (void*)(sizeof(u32) * mesh.m_FirstIndex), mesh.m_BaseVertex);
 }
 
 void Renderer::DrawMesh(const MeshRenderer& meshRenderer, const LocalToWorld& toWorld, Shader& shader) {
@@ -129,15 +232,18 @@ void Renderer::DrawMesh(const MeshRenderer& meshRenderer, const LocalToWorld& to
 void Renderer::DrawFullScreenQuad(const Shader& shader) {
 	static Mesh presentPlane = Primatives::Plane();
 	shader.Bind();
-	glBindVertexArray(presentPlane.m_Vao);
+	GLState::BindVertexArray(presentPlane.m_Vao);
 	glDrawElements(GL_TRIANGLES, presentPlane.m_NumIndices, GL_UNSIGNED_INT, nullptr);
 }
 
 void Renderer::DrawMesh(const Mesh& mesh, const LocalToWorld& toWorld, Shader& shader) {
+	// Shaders taking a model matrix read it per instance, so single draws go through the instance buffer too
+	const InstanceData instance = InstanceBuffer::Record(toWorld.matrix, toWorld.matrix.InverseTranspose(), 0);
+	InstanceBuffer::Upload(&instance, 1);
+
 	shader.Bind();
-	shader.SetMat4("model", toWorld.matrix);
-	glBindVertexArray(mesh.m_Vao);
-	glDrawElements(GL_TRIANGLES, mesh.m_NumIndices, GL_UNSIGNED_INT, nullptr);
+	GLState::BindVertexArray(mesh.m_Vao);
+	glDrawElementsInstancedBaseVertex(GL_TRIANGLES, mesh.m_NumIndices, GL_UNSIGNED_INT, (void*)(sizeof(u32) * mesh.m_FirstIndex), 1, mesh.m_BaseVertex);
 }
 
 void Renderer::DebugDrawBounds(glm::vec3* points) {
@@ -152,7 +258,7 @@ void Renderer::DebugDrawBounds(glm::vec3* points) {
 	}
 	cube.UpdateVertexBuffer();
 
-	glBindVertexArray(cube.m_Vao);
+	GLState::BindVertexArray(cube.m_Vao);
 	glDrawElements(GL_LINE_LOOP, cube.m_NumIndices, GL_UNSIGNED_INT, nullptr);
 }
 
@@ -168,7 +274,7 @@ void Renderer::DebugDrawPoint(const glm::vec3 point) {
 
 	debugShader.SetMat4("model", model);
 
-	glBindVertexArray(cube.m_Vao);
+	GLState::BindVertexArray(cube.m_Vao);
 	glDrawElements(GL_TRIANGLES, cube.m_NumIndices, GL_UNSIGNED_INT, nullptr);
 }
 
@@ -176,15 +282,15 @@ void Renderer::DrawSkybox() {
 	static Mesh skyboxMesh = Primatives::Cube(true);
 	static Shader skyboxShader = Shader("src/shaders/Skybox.vert", "src/shaders/Skybox.frag");
 
-	glDepthMask(GL_FALSE);
-	glDepthFunc(GL_LEQUAL);
+	GLState::DepthMask(false);
+	GLState::DepthFunc(GL_LEQUAL);
 
 	skyboxShader.Bind();
 	Enviroment::Instance()->BindSkybox(0);
 
-	glBindVertexArray(skyboxMesh.m_Vao);
+	GLState::BindVertexArray(skyboxMesh.m_Vao);
 	glDrawElements(GL_TRIANGLES, skyboxMesh.m_NumIndices, GL_UNSIGNED_INT, nullptr);
 
-	glDepthFunc(GL_LESS);
-	glDepthMask(GL_TRUE);
+	GLState::DepthFunc(GL_LESS);
+	GLState::DepthMask(true);
 }
@@ -4,12 +4,20 @@
 #include "Enviroment.h"
 #include "core/Components.h"
 #include "FrameBuffer.h"
+#include "FramePacket.h"
+#include "RenderQueue.h"
 
 class Renderer {
 public:
     static void Init();
-    static void RenderScene(Registry& registry);
+    static void RenderScene();
+
+    // Extracts the frame packet from the registry and renders the shadow pass from it
     static void NewFrame(Registry& registry);
+
+    // Copies what the renderer needs out of the registry into the back packet and makes it current
+    static void ExtractScene(Registry& registry);
+    static const FramePacket& CurrentFramePacket() { return m_FramePackets[m_CurrentPacket]; }
     static void EndFrame();
     static void PresentFrame();
 
@@ -35,13 +43,43 @@ public:
         f32 exposure;
     };
     
+    // Counted while submitting the scene pass
+    struct RenderStats {
+        // Multi draw calls, the indirect commands they submitted and the instances of those
+        u32 drawCalls;
+        u32 commands;
+        u32 instances;
+        u32 shaderBinds;
+        u32 materialBinds;
+        u32 vaoBinds;
+    };
+
+    static const RenderStats& GetStats() { return m_Stats; }
+
     static PostProcessingParams GetPostProcessingParams() { return m_PostProcessingParams; }
     static void SetPostProcessingParams(const PostProcessingParams& params) { m_PostProcessingParams = params; }
 private:
     static void DrawSkybox();
+    static void ExtractStaticItems(Registry& registry);
+    static void PushDrawItems(Registry& registry, Entity entity, const MeshRenderer& meshRenderer, std::vector<DrawItem>& items);
 private:
     inline static FrameBuffer m_HdrFrameBuffer;
     inline static FrameBuffer m_SrgbFrameBuffer;
     inline static PostProcessingParams m_PostProcessingParams;
+    inline static RenderStats m_Stats;
+
+    // Kept between frames so its buffers are reused
+    inline static RenderQueue m_RenderQueue;
+
+    // Double buffered so the next packet can be extracted while the current one is still in use
+    inline static FramePacket m_FramePackets[2];
+    inline static u32 m_CurrentPacket = 0;
+
+    // Draw items of static entities with their world bounds, rebuilt when the registry's structure changes.
+    // m_StaticItemsVersion counts rebuilds so each frame packet can tell whether its copy is stale.
+    inline static std::vector<DrawItem> m_StaticItems;
+    inline static u32 m_StaticItemsVersion = 0;
+    inline static u32 m_StaticStructureChanges = 0;
+    inline static u32 m_StaticRegistryId = static_cast<u32>(-1);
 };
 
@@ -3,6 +3,7 @@
 #include <sstream>
 #include <glm/gtc/type_ptr.hpp>
 #include <glad/glad.h>
+#include "GLState.h"
 #include "Shader.h"
 
 Shader::Shader(const std::string& vertFile, const std::string& fragFile) {
@@ -10,7 +11,7 @@ Shader::Shader(const std::string& vertFile, const std::string& fragFile) {
 }
 
 void Shader::Bind() const {
-    glUseProgram(m_ShaderId);
+    GLState::UseProgram(m_ShaderId);
 }
 
 void Shader::SetInt(const std::string& name, i32 num) {
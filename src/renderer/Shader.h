@@ -9,6 +9,8 @@ public:
     Shader() = default;
     Shader(const std::string& vertFile, const std::string& fragFile);
     void Bind() const;
+    // Program name, shared by every copy of the same shader
+    u32 Id() const { return static_cast<u32>(m_ShaderId); }
     void SetInt(const std::string& name, i32 num);
     void SetFloat(const std::string& name, f32 num);
     void SetVec2(const std::string& name, const glm::vec2& vec);
@@ -3,8 +3,10 @@
 #include "Renderer.h"
 #include "core/CameraSystem.h"
 #include "Enviroment.h"
-#include "ecs/Registry.h"
-#include "ecs/View.h"
+#include "FramePacket.h"
+#include "GLState.h"
+#include "IndirectBuffer.h"
+#include "InstanceBuffer.h"
 #include "ShadowMapper.h"
 
 void ShadowMapper::Init(const u32 textureSize, const f32 shadowDist) {
@@ -15,46 +17,46 @@ void ShadowMapper::Init(const u32 textureSize, const f32 shadowDist) {
 	m_DepthShader = Shader("src/shaders/Depth.vert", "src/shaders/Depth.frag");
 
 	glGenFramebuffers(1, &m_DepthFrameBuffer);
-	glBindFramebuffer(GL_FRAMEBUFFER, m_DepthFrameBuffer);
+	GLState::BindFramebuffer(m_DepthFrameBuffer);
 	m_ShadowMap.AttachToActiveFrameBuffer();
 
 	// Need to explicitly tell OpenGL we're not using color
 	glDrawBuffer(GL_NONE);
 	glReadBuffer(GL_NONE);
 
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLState::BindFramebuffer(0);
 }
 
-void ShadowMapper::PerformShadowPass(Registry& registry) {
+void ShadowMapper::PerformShadowPass(const FramePacket& packet) {
 	CalculateLightViewProjection();
 
-	i32 viewportDimensions[4];
-	glGetIntegerv(GL_VIEWPORT, viewportDimensions);
-	i32 viewportWidth = viewportDimensions[2];
-	i32 viewportHeight = viewportDimensions[3];
-
-	glViewport(0, 0, m_TextureSize, m_TextureSize);
-	glBindFramebuffer(GL_FRAMEBUFFER, m_DepthFrameBuffer);
+	const glm::i32vec4 previousViewport = GLState::GetViewport();
+	GLState::Viewport({ 0, 0, m_TextureSize, m_TextureSize });
+	GLState::BindFramebuffer(m_DepthFrameBuffer);
 	glClear(GL_DEPTH_BUFFER_BIT);
 
 	m_DepthShader.Bind();
 	m_DepthShader.SetMat4("viewProjection", m_LightViewProjection);
 
-	const auto view = View<LocalToWorld, Transform, MeshRenderer>(registry);
-	for (const auto entity : view) {
-		auto& toWorld = registry.Get<LocalToWorld>(entity);
-		const auto& meshRenderer = registry.Get<MeshRenderer>(entity);
-		
-		m_DepthShader.SetMat4("model", toWorld.matrix);
-
-		for (const auto& mesh : meshRenderer.meshes) {
-			glBindVertexArray(mesh.m_Vao);
-			glDrawElements(GL_TRIANGLES, mesh.m_NumIndices, GL_UNSIGNED_INT, 0);
-		}
+	// Only the mesh matters for depth, so casters are sorted by it and every mesh is drawn once, instanced.
+	// All heap meshes end up in one batch, leaving a multi draw per standalone VAO on top of it.
+	m_CasterQueue.Clear();
+	packet.ForEachItem([](const DrawItem& item) {
+		m_CasterQueue.PushMeshOnly(item);
+	});
+	m_CasterQueue.Sort();
+	m_CasterQueue.BuildBatches(false);
+
+	InstanceBuffer::Upload(packet, m_CasterQueue);
+	IndirectBuffer::Upload(m_CasterQueue.Commands());
+
+	for (const RenderQueue::Batch& batch : m_CasterQueue.Batches()) {
+		GLState::BindVertexArray(batch.item->vao);
+		IndirectBuffer::MultiDraw(batch.firstCommand, batch.commandCount);
 	}
 	
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
-	glViewport(0, 0, viewportWidth, viewportHeight);
+	GLState::BindFramebuffer(0);
+	GLState::Viewport(previousViewport);
 
 	Enviroment::Instance()->SetLightViewProjection(m_LightViewProjection);
 }
@@ -1,15 +1,16 @@
 #pragma once
 #include "core/Base.h"
 #include "DepthTexture.h"
+#include "RenderQueue.h"
 #include "Shader.h"
 #include <glm/glm.hpp>
 
-class Registry;
+struct FramePacket;
 
 class ShadowMapper {
 public:
 	static void Init(const u32 textureSize, const f32 shadowDist);
-	static void PerformShadowPass(Registry& registry);
+	static void PerformShadowPass(const FramePacket& packet);
 	static void BindShadowMap(const i32 textureUnit);
 private:
 	static void CalculateLightViewProjection();
@@ -20,5 +21,6 @@ private:
     inline static u32 m_TextureSize;
     inline static u32 m_DepthFrameBuffer;
     inline static f32 m_ShadowDist;
+    inline static RenderQueue m_CasterQueue;
 };
 
@@ -19,7 +19,7 @@ Ref<Texture> Texture::Load(const std::string& filePath, const Type texType) {
 
     u32 id;
     glGenTextures(1, &id);
-    glBindTexture(GL_TEXTURE_2D, id);
+    GLState::BindTexture(GL_TEXTURE_2D, id);
 
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -46,6 +46,7 @@ Texture::Texture(const u32 width, const u32 height, const u32 id, const std::str
 Texture::~Texture() {
     m_ActiveTextures.erase(m_Path);
     glDeleteTextures(1, &m_Id);
+    GLState::OnTextureDeleted(m_Id);
 }
 
 i32 Texture::GetFormat(const i32 numChannels) {
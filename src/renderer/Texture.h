@@ -3,6 +3,7 @@
 #include <unordered_map>
 #include <glad/glad.h>
 #include "core/Base.h"
+#include "GLState.h"
 
 class Texture {
 public:
@@ -13,7 +14,7 @@ public:
     Texture(const u32 width, const u32 height, const u32 id, const std::string& path);
     ~Texture();
 
-    void Bind() const { glBindTexture(GL_TEXTURE_2D, m_Id); }
+    void Bind(const u32 textureUnit) const { GLState::BindTexture(textureUnit, GL_TEXTURE_2D, m_Id); }
 
     std::string Path() const { return m_Path; }
     bool HasTransparency() const { return m_HasTransparency; }
@@ -2,9 +2,20 @@
 
 layout (location = 0) in vec3 iPos;
 
-uniform mat4 model;
+// Matches InstanceData, model holds the top three rows of the affine model matrix so
+// vec4(position, 1.0) * model gives the world position
+struct Instance {
+	mat3x4 model;
+	mat3 normalMatrix;
+	uint materialIndex;
+};
+
+layout (std430, binding = 2) readonly buffer instanceBuffer {
+	Instance instances[];
+};
 uniform mat4 viewProjection;
 
 void main() {
-	gl_Position = viewProjection * model * vec4(iPos, 1.0);
+	mat3x4 model = instances[gl_BaseInstance + gl_InstanceID].model;
+	gl_Position = viewProjection * vec4(vec4(iPos, 1.0) * model, 1.0);
 }
@@ -5,24 +5,47 @@ in vec3 modelNormal;
 in vec2 textureCoord;
 in mat3 tbn;
 in vec4 lightFragPos;
+flat in uint materialIndex;
 
-layout (location = 0) uniform sampler2D albedoMap;
-layout (location = 1) uniform sampler2D normalMap;
-layout (location = 2) uniform sampler2D metallicRoughnessMap;
-layout (location = 3) uniform sampler2D shadowMap;
-layout (location = 4) uniform samplerCube skybox;
-layout (location = 5) uniform sampler3D shadowPcfMap;
+// Units are fixed, 0-2 are bound per material and 3-5 once per pass
+layout (binding = 0) uniform sampler2D albedoMap;
+layout (binding = 1) uniform sampler2D normalMap;
+layout (binding = 2) uniform sampler2D metallicRoughnessMap;
+layout (binding = 3) uniform sampler2D shadowMap;
+layout (binding = 4) uniform samplerCube skybox;
+layout (binding = 5) uniform sampler3D shadowPcfMap;
 
-uniform bool albedoMapEnabled;
-uniform bool normalMapEnabled;
-uniform bool metallicRoughnessMapEnabled;
-uniform bool alphaClippingEnabled;
-uniform float alphaCutoff;
+// Matches MaterialData
+struct MaterialRecord {
+	vec2 tiling;
+	float roughness;
+	float metallic;
+	float specularStrength;
+	float alphaCutoff;
+	uint flags;
+	uint padding;
+};
+
+layout (std430, binding = 3) readonly buffer materialBuffer {
+	MaterialRecord materials[];
+};
 
-uniform float roughness;
-uniform float specularStrength;
-uniform float metallic;
-uniform vec2 tiling;
+const uint AlbedoMapFlag = 1u;
+const uint NormalMapFlag = 2u;
+const uint MetallicRoughnessMapFlag = 4u;
+const uint AlphaClippingFlag = 8u;
+
+// Filled from the material's record at the start of main
+bool albedoMapEnabled;
+bool normalMapEnabled;
+bool metallicRoughnessMapEnabled;
+bool alphaClippingEnabled;
+float alphaCutoff;
+
+float roughness;
+float specularStrength;
+float metallic;
+vec2 tiling;
 
 layout (std140, binding = 0) uniform camera {
 	vec3 camPos;
@@ -175,6 +198,17 @@ float CalculateShadow() {
 }
 
 void main() {
+    MaterialRecord material = materials[materialIndex];
+    albedoMapEnabled = (material.flags & AlbedoMapFlag) != 0u;
+    normalMapEnabled = (material.flags & NormalMapFlag) != 0u;
+    metallicRoughnessMapEnabled = (material.flags & MetallicRoughnessMapFlag) != 0u;
+    alphaClippingEnabled = (material.flags & AlphaClippingFlag) != 0u;
+    alphaCutoff = material.alphaCutoff;
+    roughness = material.roughness;
+    specularStrength = material.specularStrength;
+    metallic = material.metallic;
+    tiling = material.tiling;
+
     vec4 albedoColorWithAlpha = vec4(1.0f);
     vec3 albedoColor = vec3(1.0f);
     vec2 tiledTexCoord = textureCoord * tiling;
@@ -25,26 +25,43 @@ layout (std140, binding = 1) uniform enviorment {
     float shadowStrength;
 };
 
-uniform mat4 model;
+// Matches InstanceData, model holds the top three rows of the affine model matrix so
+// vec4(position, 1.0) * model gives the world position. normalMatrix is its inverse transpose,
+// computed on the CPU whenever the transform changes.
+struct Instance {
+	mat3x4 model;
+	mat3 normalMatrix;
+	uint materialIndex;
+};
+
+layout (std430, binding = 2) readonly buffer instanceBuffer {
+	Instance instances[];
+};
 
 out vec3 fragPos;
 out vec3 modelNormal;
 out vec2 textureCoord;
 out mat3 tbn;
 out vec4 lightFragPos;
+flat out uint materialIndex;
 
 void main() {
+	Instance instance = instances[gl_BaseInstance + gl_InstanceID];
+	mat3x4 model = instance.model;
+	mat3 normalMatrix = instance.normalMatrix;
+	materialIndex = instance.materialIndex;
+
 	textureCoord = iTextureCoord;
-	fragPos = vec3(model * vec4(iPos, 1.0));
+	fragPos = vec4(iPos, 1.0) * model;
 	lightFragPos = lightViewProjection * vec4(fragPos, 1.0);
-	modelNormal = normalize(mat3(transpose(inverse(model))) * iNormal);
+	modelNormal = normalize(normalMatrix * iNormal);
 
 	// Calculate tbn matrix
-	mat3 normalMatrix = mat3(model);
-	vec3 normal = normalize(normalMatrix * iNormal);
-	vec3 tangent = normalize(normalMatrix * iTangent);
+	mat3 model3 = transpose(mat3(model));
+	vec3 normal = normalize(model3 * iNormal);
+	vec3 tangent = normalize(model3 * iTangent);
 	vec3 bitangent = normalize(cross(normal, tangent));
 	tbn = mat3(tangent, bitangent, normal);
 	
-	gl_Position = viewProjection * model * vec4(iPos, 1.0);
+	gl_Position = viewProjection * vec4(fragPos, 1.0);
 }